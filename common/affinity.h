@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "harness.h"
+
+// Топология из /sys/devices/system/cpu и привязка потоков OpenMP к ядрам.
+
+struct CpuInfo {
+    int cpu;
+    int package;
+    int core;  // номер физического ядра внутри пакета (по порядку, не core_id)
+    int smt;   // номер среди SMT-братьев одного ядра
+};
+
+// Список "0-3,8,10-11" → номера
+inline std::vector<int> parse_cpu_list(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty())
+            continue;
+        size_t dash = item.find('-');
+        int lo = std::stoi(item.substr(0, dash));
+        int hi = dash == std::string::npos ? lo : std::stoi(item.substr(dash + 1));
+        for (int c = lo; c <= hi; c++)
+            out.push_back(c);
+    }
+    return out;
+}
+
+inline int read_sys_int(const std::string& path, int def) {
+    std::ifstream f(path);
+    int v;
+    return (f >> v) ? v : def;
+}
+
+inline std::vector<CpuInfo> read_topology() {
+    std::vector<int> cpus;
+    {
+        std::ifstream f("/sys/devices/system/cpu/online");
+        std::string line;
+        if (std::getline(f, line))
+            cpus = parse_cpu_list(line);
+    }
+    if (cpus.empty())
+        for (long c = 0; c < sysconf(_SC_NPROCESSORS_ONLN); c++)
+            cpus.push_back((int)c);
+
+    // (package, core_id) → список логических cpu этого ядра
+    std::map<std::pair<int, int>, std::vector<int>> cores;
+    for (int c : cpus) {
+        std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+        int package = read_sys_int(dir + "physical_package_id", 0);
+        int core_id = read_sys_int(dir + "core_id", c);
+        cores[std::make_pair(package, core_id)].push_back(c);
+    }
+    std::vector<CpuInfo> topo;
+    std::map<int, int> cores_in_package;
+    for (auto& k : cores) {
+        int package = k.first.first;
+        int core = cores_in_package[package]++;
+        std::sort(k.second.begin(), k.second.end());
+        for (size_t s = 0; s < k.second.size(); s++)
+            topo.push_back({k.second[s], package, core, (int)s});
+    }
+    return topo;
+}
+
+// Политики размещения threads потоков; пустой результат — политика неприменима:
+//   compact — пакет за пакетом: сначала по одному потоку на ядро, затем SMT-братья
+//   spread  — по кругу между пакетами, по одному на ядро, затем SMT-братья
+//   cores   — строго один поток на физическое ядро (не больше, чем ядер)
+//   smt     — SMT-братья одного ядра подряд
+//   none    — без привязки (весь набор cpu)
+inline std::vector<int> placement_cpus(const std::vector<CpuInfo>& topo, const std::string& policy, int threads) {
+    std::vector<CpuInfo> order = topo;
+    typedef std::tuple<int, int, int> Key;
+    auto sort_by = [&](Key (*key)(const CpuInfo&)) {
+        std::stable_sort(order.begin(), order.end(), [&](const CpuInfo& a, const CpuInfo& b) { return key(a) < key(b); });
+    };
+    if (policy == "compact")
+        sort_by([](const CpuInfo& c) { return Key(c.package, c.smt, c.core); });
+    else if (policy == "spread")
+        sort_by([](const CpuInfo& c) { return Key(c.smt, c.core, c.package); });
+    else if (policy == "smt")
+        sort_by([](const CpuInfo& c) { return Key(c.package, c.core, c.smt); });
+    else if (policy == "cores") {
+        order.erase(std::remove_if(order.begin(), order.end(), [](const CpuInfo& c) { return c.smt != 0; }), order.end());
+        sort_by([](const CpuInfo& c) { return Key(c.package, c.core, 0); });
+        if (threads > (int)order.size())
+            return std::vector<int>();
+    } else if (policy != "none")
+        return std::vector<int>();
+
+    std::vector<int> cpus;
+    if (order.empty())
+        return cpus;
+    // Потоков больше, чем cpu — по кругу
+    for (int t = 0; t < threads; t++)
+        cpus.push_back(order[t % order.size()].cpu);
+    return cpus;
+}
+
+// Привязать i-й поток команды OpenMP из threads потоков к cpus[i % size].
+// С all == true каждый поток получает весь набор cpus (снять привязку).
+inline void pin_omp_threads(int threads, const std::vector<int>& cpus, bool all = false) {
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (all) {
+            for (int c : cpus)
+                CPU_SET(c, &set);
+        } else {
+            CPU_SET(cpus[t % cpus.size()], &set);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+}
+
+// --affinity compact,spread,cores,smt,none — перебор политик как отдельное
+// измерение стенда; политика и набор cpu записываются в результат
+inline void add_affinity_sweep(Harness& h) {
+    if (!h.flag("affinity"))
+        return;
+    std::string list = h.option("affinity", "");
+    if (list == "1")
+        list = "none,compact,spread,cores,smt";
+    std::vector<std::string> policies;
+    std::stringstream ss(list);
+    std::string p;
+    while (std::getline(ss, p, ','))
+        if (!p.empty())
+            policies.push_back(p);
+
+    std::vector<CpuInfo> topo = read_topology();
+    h.dimension("placement", "cpus", policies, [topo](const std::string& policy, int threads) {
+        std::vector<int> cpus = placement_cpus(topo, policy, threads);
+        if (cpus.empty())
+            return std::string();
+        if (policy == "none") {
+            std::vector<int> online;
+            for (const CpuInfo& c : topo)
+                online.push_back(c.cpu);
+            pin_omp_threads(threads, online, true);
+            return std::string("all");
+        }
+        pin_omp_threads(threads, cpus);
+        std::ostringstream os;
+        for (size_t i = 0; i < cpus.size(); i++)
+            os << (i ? " " : "") << cpus[i];
+        return os.str();
+    });
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstring>
+
+// Набор SIMD-инструкций, под который выбираются ядра во время выполнения
+enum class Isa { Scalar, Sse2, Avx2, Avx512 };
+
+inline const char* isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::Sse2: return "sse2";
+    case Isa::Avx2: return "avx2";
+    case Isa::Avx512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+// Лучший набор, который поддерживает процессор (по CPUID)
+inline Isa detect_isa() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return Isa::Avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return Isa::Avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return Isa::Sse2;
+#endif
+    return Isa::Scalar;
+}
+
+// Разбор имени ("avx2" и т.п.); неизвестное имя даёт fallback
+inline Isa isa_from_name(const char* name, Isa fallback) {
+    const Isa all[] = {Isa::Scalar, Isa::Sse2, Isa::Avx2, Isa::Avx512};
+    for (Isa isa : all)
+        if (std::strcmp(name, isa_name(isa)) == 0)
+            return isa;
+    return fallback;
+}
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Общий стенд для замеров во всех лабах.
+//
+//   Harness h(argc, argv, {20000, 40000}, {1, 2, 4, 7, 8, 16, 20, 40});
+//   h.add("scale", [&](long n) { ...подготовка...; Case c; c.run = [=](int threads) { return секунды; }; return c; });
+//   return h.run();
+//
+// Командная строка:
+//   --sizes 20000,40000   --threads 1,2,4   --reps 3   --warmup 1
+//   --kernels scale,fused --json out.json   --csv out.csv
+//   --perf                (счётчики perf_event_open, если лаба их подключила)
+//   --affinity compact,spread,cores,smt,none (привязка потоков OpenMP, affinity.h)
+// плюс опции конкретной лабы (option/flag).
+
+// Один зарегистрированный замер для данного размера
+struct Case {
+    // Один прогон на threads потоках, возвращает время в секундах
+    std::function<double(int)> run;
+    // Пары "имя метрики" → объём работы за прогон; в отчёт идёт объём / медиана
+    // (например, {"GB/s", байты / 1e9})
+    std::vector<std::pair<std::string, double>> rates;
+    std::vector<std::pair<std::string, std::string>> tags;
+};
+
+struct BenchResult {
+    std::string kernel;
+    long size = 0;
+    int threads = 0;
+    double setup = 0;           // время подготовки данных этого размера
+    std::vector<double> times;  // по повторениям
+    double median = 0, min = 0, max = 0, stddev = 0;
+    double speedup = 1, efficiency = 1;
+    std::vector<std::pair<std::string, std::string>> tags;
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+// Обёртка вокруг каждого повторения замера (например, счётчики
+// производительности, см. perf_counters.h)
+class Probe {
+public:
+    virtual ~Probe() {}
+    virtual void begin(int threads) = 0;
+    virtual void end() = 0;
+    // Перенести накопленное за повторения в результат
+    virtual void report(BenchResult& r) = 0;
+};
+
+class Harness {
+public:
+    Harness(int argc, char** argv, std::vector<long> sizes, std::vector<int> threads)
+        : sizes_(std::move(sizes)), threads_(std::move(threads)) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") != 0) {
+                args_.push_back(arg);
+                continue;
+            }
+            std::string key = arg.substr(2), value = "1";
+            size_t eq = key.find('=');
+            if (eq != std::string::npos) {
+                value = key.substr(eq + 1);
+                key = key.substr(0, eq);
+            } else if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0) {
+                value = argv[++i];
+            }
+            options_[key] = value;
+        }
+        if (options_.count("sizes"))
+            sizes_ = parse_list<long>(options_["sizes"]);
+        if (options_.count("threads"))
+            threads_ = parse_list<int>(options_["threads"]);
+        reps_ = (int)option("reps", 3L);
+        warmup_ = (int)option("warmup", 1L);
+        if (options_.count("kernels"))
+            only_ = parse_list<std::string>(options_["kernels"]);
+    }
+
+    const std::vector<long>& sizes() const { return sizes_; }
+    const std::vector<int>& threads() const { return threads_; }
+    // Аргументы без "--"
+    const std::vector<std::string>& args() const { return args_; }
+
+    std::string option(const std::string& name, const std::string& def) const {
+        auto it = options_.find(name);
+        return it == options_.end() ? def : it->second;
+    }
+    std::string option(const std::string& name, const char* def) const { return option(name, std::string(def)); }
+    long option(const std::string& name, long def) const {
+        auto it = options_.find(name);
+        return it == options_.end() ? def : std::strtol(it->second.c_str(), nullptr, 10);
+    }
+    int option(const std::string& name, int def) const { return (int)option(name, (long)def); }
+    double option(const std::string& name, double def) const {
+        auto it = options_.find(name);
+        return it == options_.end() ? def : std::strtod(it->second.c_str(), nullptr);
+    }
+    // Опция-список через запятую: --pages small,thp
+    std::vector<std::string> list(const std::string& name, const std::string& def) const {
+        return parse_list<std::string>(option(name, def));
+    }
+    bool flag(const std::string& name) const {
+        auto it = options_.find(name);
+        return it != options_.end() && it->second != "0";
+    }
+
+    // setup(n) готовит данные размера n (в замер не входит) и возвращает Case
+    void add(const std::string& kernel, std::function<Case(long)> setup) {
+        if (only_.empty() || std::find(only_.begin(), only_.end(), kernel) != only_.end())
+            kernels_.push_back(std::make_pair(kernel, setup));
+    }
+
+    // Дополнительные значения к текущему замеру — можно звать из Case::run
+    void tag(const std::string& key, const std::string& value) {
+        if (current_)
+            set(current_->tags, key, value);
+    }
+    void metric(const std::string& key, double value) {
+        if (current_)
+            set(current_->metrics, key, value);
+    }
+
+    // Дополнительное измерение перебора между ядром и числом потоков
+    // (например, привязка потоков, см. affinity.h). apply(value, threads)
+    // готовит окружение и возвращает подробности для тега detail_tag;
+    // пустая строка — комбинация неприменима и пропускается.
+    void dimension(const std::string& name, const std::string& detail_tag, std::vector<std::string> values,
+                   std::function<std::string(const std::string&, int)> apply) {
+        dim_name_ = name;
+        dim_detail_ = detail_tag;
+        dim_values_ = std::move(values);
+        dim_apply_ = apply;
+    }
+
+    // Probe вызывается вокруг каждого повторения (без прогревов)
+    void probe(Probe* p) { probes_.push_back(p); }
+
+    const std::vector<BenchResult>& results() const { return results_; }
+
+    // Все замеры: размер → ядро → число потоков; затем отчёт
+    int run() {
+        if (flag("help")) {
+            usage();
+            return 0;
+        }
+        for (long n : sizes_) {
+            for (auto& k : kernels_) {
+                auto t0 = std::chrono::steady_clock::now();
+                Case c = k.second(n);
+                double setup = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                if (!c.run)
+                    continue;
+                std::vector<std::string> values = dim_apply_ ? dim_values_ : std::vector<std::string>(1);
+                for (const std::string& value : values) {
+                    size_t first = results_.size();
+                    for (int p : threads_) {
+                        std::string detail;
+                        if (dim_apply_ && (detail = dim_apply_(value, p)).empty())
+                            continue;
+                        results_.push_back(BenchResult());
+                        BenchResult& r = results_.back();
+                        r.kernel = k.first;
+                        r.size = n;
+                        r.threads = p;
+                        r.setup = setup;
+                        r.tags = c.tags;
+                        if (dim_apply_) {
+                            r.tags.push_back(std::make_pair(dim_name_, value));
+                            r.tags.push_back(std::make_pair(dim_detail_, detail));
+                        }
+                        measure(r, c, p);
+                        const BenchResult& base = results_[first];
+                        r.speedup = base.median / r.median;
+                        r.efficiency = r.speedup * base.threads / p;
+                        print(r);
+                    }
+                }
+            }
+        }
+        if (dim_apply_)
+            print_best();
+        write_json(option("json", ""));
+        write_csv(option("csv", ""));
+        return 0;
+    }
+
+private:
+    template <typename T>
+    static std::vector<T> parse_list(const std::string& s) {
+        std::vector<T> out;
+        std::stringstream ss(s);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (item.empty())
+                continue;
+            std::stringstream is(item);
+            T v;
+            is >> v;
+            out.push_back(v);
+        }
+        return out;
+    }
+
+    template <typename V>
+    static void set(std::vector<std::pair<std::string, V>>& kv, const std::string& key, const V& value) {
+        for (auto& p : kv)
+            if (p.first == key) {
+                p.second = value;
+                return;
+            }
+        kv.push_back(std::make_pair(key, value));
+    }
+
+    void measure(BenchResult& r, const Case& c, int p) {
+        current_ = &r;
+        for (int i = 0; i < warmup_; i++)
+            c.run(p);
+        for (int i = 0; i < std::max(reps_, 1); i++) {
+            for (Probe* probe : probes_)
+                probe->begin(p);
+            r.times.push_back(c.run(p));
+            for (Probe* probe : probes_)
+                probe->end();
+        }
+        current_ = nullptr;
+
+        std::vector<double> t = r.times;
+        std::sort(t.begin(), t.end());
+        size_t m = t.size();
+        r.median = m % 2 ? t[m / 2] : 0.5 * (t[m / 2 - 1] + t[m / 2]);
+        r.min = t.front();
+        r.max = t.back();
+        double mean = 0, var = 0;
+        for (double x : t)
+            mean += x / m;
+        for (double x : t)
+            var += (x - mean) * (x - mean) / m;
+        r.stddev = std::sqrt(var);
+        for (auto& rate : c.rates)
+            set(r.metrics, rate.first, rate.second / r.median);
+        for (Probe* probe : probes_)
+            probe->report(r);
+    }
+
+    void print(const BenchResult& r) const {
+        std::cout << r.kernel << " n=" << r.size << " T" << r.threads << " = " << r.median
+                  << " [" << r.min << ".." << r.max << "]"
+                  << " S" << r.threads << " = " << r.speedup << " E" << r.threads << " = " << r.efficiency;
+        for (auto& m : r.metrics)
+            std::cout << " " << m.first << " = " << m.second;
+        for (auto& t : r.tags)
+            std::cout << " " << t.first << " = " << t.second;
+        std::cout << std::endl;
+    }
+
+    // Лучшее значение измерения (по медиане) для каждого ядра, размера и числа потоков
+    void print_best() const {
+        std::map<std::pair<std::string, std::pair<long, int>>, const BenchResult*> best;
+        for (const BenchResult& r : results_) {
+            const BenchResult*& b = best[std::make_pair(r.kernel, std::make_pair(r.size, r.threads))];
+            if (!b || r.median < b->median)
+                b = &r;
+        }
+        std::cout << "best " << dim_name_ << ":" << std::endl;
+        for (auto& kv : best) {
+            const BenchResult& r = *kv.second;
+            std::string value;
+            for (auto& t : r.tags)
+                if (t.first == dim_name_)
+                    value = t.second;
+            std::cout << r.kernel << " n=" << r.size << " T" << r.threads << " = " << r.median << " " << dim_name_
+                      << " = " << value << std::endl;
+        }
+    }
+
+    static std::string quote(const std::string& s) {
+        std::string out = "\"";
+        for (char ch : s) {
+            if (ch == '"' || ch == '\\')
+                out += '\\';
+            out += ch;
+        }
+        return out + "\"";
+    }
+
+    // nan и inf в JSON не бывает — пишется null
+    static std::string number(double v) {
+        if (!std::isfinite(v))
+            return "null";
+        std::ostringstream out;
+        out << v;
+        return out.str();
+    }
+
+    void write_json(const std::string& path) const {
+        if (path.empty())
+            return;
+        std::ofstream f(path);
+        f << "[\n";
+        for (size_t i = 0; i < results_.size(); i++) {
+            const BenchResult& r = results_[i];
+            f << "  {\"kernel\": " << quote(r.kernel) << ", \"size\": " << r.size << ", \"threads\": " << r.threads
+              << ", \"setup\": " << number(r.setup) << ", \"median\": " << number(r.median)
+              << ", \"min\": " << number(r.min) << ", \"max\": " << number(r.max) << ", \"stddev\": " << number(r.stddev)
+              << ", \"speedup\": " << number(r.speedup) << ", \"efficiency\": " << number(r.efficiency)
+              << ", \"times\": [";
+            for (size_t j = 0; j < r.times.size(); j++)
+                f << (j ? ", " : "") << number(r.times[j]);
+            f << "]";
+            for (auto& m : r.metrics)
+                f << ", " << quote(m.first) << ": " << number(m.second);
+            for (auto& t : r.tags)
+                f << ", " << quote(t.first) << ": " << quote(t.second);
+            f << "}" << (i + 1 < results_.size() ? "," : "") << "\n";
+        }
+        f << "]\n";
+    }
+
+    void write_csv(const std::string& path) const {
+        if (path.empty())
+            return;
+        std::ofstream f(path);
+        f << "kernel,size,threads,setup,median,min,max,stddev,speedup,efficiency,metrics,tags\n";
+        for (const BenchResult& r : results_) {
+            f << r.kernel << "," << r.size << "," << r.threads << "," << r.setup << "," << r.median << ","
+              << r.min << "," << r.max << "," << r.stddev << "," << r.speedup << "," << r.efficiency << ",";
+            for (size_t j = 0; j < r.metrics.size(); j++)
+                f << (j ? ";" : "") << r.metrics[j].first << "=" << r.metrics[j].second;
+            f << ",";
+            for (size_t j = 0; j < r.tags.size(); j++)
+                f << (j ? ";" : "") << r.tags[j].first << "=" << r.tags[j].second;
+            f << "\n";
+        }
+    }
+
+    void usage() const {
+        std::cout << "--sizes a,b,..  --threads p,q,..  --reps N  --warmup N\n"
+                     "--kernels k1,k2  --json file  --csv file  --perf  --affinity p1,p2\nkernels:";
+        for (auto& k : kernels_)
+            std::cout << " " << k.first;
+        std::cout << std::endl;
+    }
+
+    std::vector<long> sizes_;
+    std::vector<int> threads_;
+    std::vector<std::string> args_;
+    std::vector<std::string> only_;
+    std::map<std::string, std::string> options_;
+    int reps_ = 3;
+    int warmup_ = 1;
+    std::vector<std::pair<std::string, std::function<Case(long)>>> kernels_;
+    std::vector<BenchResult> results_;
+    std::vector<Probe*> probes_;
+    std::string dim_name_, dim_detail_;
+    std::vector<std::string> dim_values_;
+    std::function<std::string(const std::string&, int)> dim_apply_;
+    BenchResult* current_ = nullptr;
+};
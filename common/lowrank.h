@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include "matrix.h"
+
+// Матрица вида A = diag(d) + U·Vᵀ, U и V — n×r (строка i — множители строки/столбца i).
+// Сгенерированные в лабах матрицы именно такие:
+//   lab2/1: a[i][j] = (i + j) * b[j]  → d = 0, U = [i, 1], V = [b_j, j·b_j]
+//   lab2/3: I + 11ᵀ                   → d = 1, U = V = [1]
+// Память O(n·r) вместо O(n²), умножение на вектор — O(n·r).
+// Плотная Matrix остаётся основным путём и эталоном для сверки (to_dense).
+class LowRankMatrix {
+public:
+    LowRankMatrix() {}
+    LowRankMatrix(size_t n, size_t rank) : d_(n, 0.0), U_(n, rank, PagePolicy::Small), V_(n, rank, PagePolicy::Small) {
+        for (size_t i = 0; i < n; i++)
+            for (size_t k = 0; k < rank; k++)
+                U_(i, k) = V_(i, k) = 0.0;
+    }
+
+    size_t rows() const { return d_.size(); }
+    size_t rank() const { return U_.cols(); }
+
+    std::vector<double>& d() { return d_; }
+    const std::vector<double>& d() const { return d_; }
+    Matrix<double>& U() { return U_; }
+    const Matrix<double>& U() const { return U_; }
+    Matrix<double>& V() { return V_; }
+    const Matrix<double>& V() const { return V_; }
+
+    // Элемент a[i][j] за O(r)
+    double operator()(size_t i, size_t j) const {
+        const double* u = U_.row(i);
+        const double* v = V_.row(j);
+        double s = i == j ? d_[i] : 0.0;
+        for (size_t k = 0; k < rank(); k++)
+            s += u[k] * v[k];
+        return s;
+    }
+    double diag(size_t i) const { return (*this)(i, i); }
+
+    // t = Vᵀx (r чисел), из любого места внутри параллельного региона:
+    // вызывают все потоки команды (orphaned omp for), t общий
+    void project(const double* x, std::vector<double>& t) const {
+        const long n = (long)rows();
+        const size_t r = rank();
+        #pragma omp single
+        t.assign(r, 0.0);
+        std::vector<double> local(r, 0.0);
+        #pragma omp for schedule(static) nowait
+        for (long j = 0; j < n; j++) {
+            const double* v = V_.row(j);
+            for (size_t k = 0; k < r; k++)
+                local[k] += v[k] * x[j];
+        }
+        #pragma omp critical(lowrank_project)
+        for (size_t k = 0; k < r; k++)
+            t[k] += local[k];
+        #pragma omp barrier
+    }
+
+    // y = A·x = d∘x + U·(Vᵀx)
+    void matvec(const double* x, double* y, int thread_numb) const {
+        const long n = (long)rows();
+        const size_t r = rank();
+        std::vector<double> t;
+        #pragma omp parallel num_threads(thread_numb)
+        {
+            project(x, t);
+            #pragma omp for schedule(static)
+            for (long i = 0; i < n; i++) {
+                const double* u = U_.row(i);
+                double s = d_[i] * x[i];
+                for (size_t k = 0; k < r; k++)
+                    s += u[k] * t[k];
+                y[i] = s;
+            }
+        }
+    }
+
+    // A ← A·diag(b): a[i][j] *= b[j] — масштабируются d и строки V
+    void scale_columns(const double* b, int thread_numb) {
+        const long n = (long)rows();
+        const size_t r = rank();
+        #pragma omp parallel for schedule(static) num_threads(thread_numb)
+        for (long j = 0; j < n; j++) {
+            d_[j] *= b[j];
+            double* v = V_.row(j);
+            for (size_t k = 0; k < r; k++)
+                v[k] *= b[j];
+        }
+    }
+
+    // Плотная копия для сверки с обычным путём
+    void to_dense(Matrix<double>& A, int thread_numb) const {
+        const long n = (long)rows();
+        #pragma omp parallel for schedule(static) num_threads(thread_numb)
+        for (long i = 0; i < n; i++)
+            for (long j = 0; j < n; j++)
+                A(i, j) = (*this)(i, j);
+    }
+
+private:
+    std::vector<double> d_;
+    Matrix<double> U_;
+    Matrix<double> V_;
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Матрица в файле, отображённом в память (mmap). Раскладка как у Matrix:
+// построчно, строки дополнены до 64 байт. В памяти держится только окно
+// из нескольких тайлов (блоков строк) — см. for_each_tile ниже.
+template <typename T>
+class MappedMatrix {
+public:
+    static const size_t alignment = 64;
+
+    // Файл создаётся (или перезаписывается) под нужный размер.
+    // Если keep_file == false, файл удаляется при разрушении объекта.
+    MappedMatrix(const std::string& path, size_t rows, size_t cols, bool keep_file = false)
+        : path_(path), rows_(rows), cols_(cols), ld_(padded(cols)), keep_file_(keep_file) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0)
+            throw std::runtime_error("MappedMatrix: cannot open " + path);
+        if (bytes() == 0)
+            return;
+        if (::ftruncate(fd_, (off_t)bytes()) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("MappedMatrix: cannot resize " + path);
+        }
+        void* p = ::mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd_);
+            throw std::runtime_error("MappedMatrix: mmap failed for " + path);
+        }
+        data_ = static_cast<T*>(p);
+        // Доступ последовательный: ядро читает с упреждением
+        ::madvise(data_, bytes(), MADV_SEQUENTIAL);
+    }
+
+    MappedMatrix(const MappedMatrix&) = delete;
+    MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+    ~MappedMatrix() {
+        if (data_)
+            ::munmap(data_, bytes());
+        if (fd_ >= 0)
+            ::close(fd_);
+        if (!keep_file_)
+            ::unlink(path_.c_str());
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t ld() const { return ld_; }
+    size_t bytes() const { return rows_ * ld_ * sizeof(T); }
+
+    T* row(size_t i) { return data_ + i * ld_; }
+    const T* row(size_t i) const { return data_ + i * ld_; }
+    T* operator[](size_t i) { return row(i); }
+    const T* operator[](size_t i) const { return row(i); }
+
+    // Попросить ядро заранее подкачать строки [r0, r1)
+    void prefetch(size_t r0, size_t r1) const {
+        std::pair<char*, size_t> r = page_range(r0, r1, false);
+        if (r.second)
+            ::madvise(r.first, r.second, MADV_WILLNEED);
+    }
+
+    // Отпустить строки [r0, r1): грязные страницы сбрасываются на диск,
+    // затем страницы убираются и из отображения, и из page cache —
+    // так резидентная память остаётся в пределах окна
+    void release(size_t r0, size_t r1, bool dirty) const {
+        std::pair<char*, size_t> r = page_range(r0, r1, true);
+        if (!r.second)
+            return;
+        if (dirty)
+            ::msync(r.first, r.second, MS_SYNC);
+        ::madvise(r.first, r.second, MADV_DONTNEED);
+        ::posix_fadvise(fd_, r.first - reinterpret_cast<char*>(data_), r.second, POSIX_FADV_DONTNEED);
+    }
+
+private:
+    static size_t padded(size_t cols) {
+        size_t per_line = alignment / sizeof(T);
+        return per_line ? (cols + per_line - 1) / per_line * per_line : cols;
+    }
+
+    // Диапазон страниц, покрывающий строки [r0, r1). При release (before_end)
+    // конец округляется вниз: страница на стыке со следующим тайлом
+    // отпускается вместе с ним, а предыдущий тайл к этому моменту уже обработан
+    std::pair<char*, size_t> page_range(size_t r0, size_t r1, bool before_end) const {
+        const size_t page = (size_t)::sysconf(_SC_PAGESIZE);
+        size_t begin = r0 * ld_ * sizeof(T) / page * page;
+        size_t end = r1 * ld_ * sizeof(T);
+        if (before_end && r1 < rows_)
+            end = end / page * page;
+        char* base = reinterpret_cast<char*>(data_);
+        return std::make_pair(base + begin, end > begin ? end - begin : 0);
+    }
+
+    std::string path_;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t ld_ = 0;
+    bool keep_file_ = false;
+    int fd_ = -1;
+    T* data_ = nullptr;
+};
+
+// Число строк в тайле, чтобы окно из двух тайлов (текущий и подкачиваемый)
+// укладывалось в window_bytes
+template <typename T>
+size_t tile_rows_for(const MappedMatrix<T>& m, size_t window_bytes) {
+    size_t row_bytes = m.ld() * sizeof(T);
+    size_t rows = row_bytes ? window_bytes / (2 * row_bytes) : m.rows();
+    return rows ? rows : 1;
+}
+
+// Обход матрицы тайлами по tile_rows строк: пока f(r0, r1) обрабатывает
+// текущий тайл, следующий подкачивается, а обработанный отпускается.
+// Возвращает объём прошедших через окно данных в байтах (для dirty —
+// чтение и запись).
+template <typename T, typename F>
+double for_each_tile(const MappedMatrix<T>& m, size_t tile_rows, bool dirty, F f) {
+    const size_t n = m.rows();
+    if (n)
+        m.prefetch(0, std::min(tile_rows, n));
+    for (size_t r0 = 0; r0 < n; r0 += tile_rows) {
+        size_t r1 = std::min(r0 + tile_rows, n);
+        if (r1 < n)
+            m.prefetch(r1, std::min(r1 + tile_rows, n));
+        f(r0, r1);
+        m.release(r0, r1, dirty);
+    }
+    return (dirty ? 2.0 : 1.0) * m.bytes();
+}
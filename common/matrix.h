@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+
+// Какими страницами выделять большие массивы:
+//   Small       — обычные 4 КБ
+//   Transparent — прозрачные huge pages (THP), madvise(MADV_HUGEPAGE)
+//   HugeTlb     — явные 2 МБ страницы hugetlbfs (MAP_HUGETLB), нужен пул vm.nr_hugepages
+// Если запрошенное недоступно, выделение откатывается на следующий по списку вниз.
+enum class PagePolicy { Small, Transparent, HugeTlb };
+
+inline const char* page_policy_name(PagePolicy p) {
+    switch (p) {
+    case PagePolicy::Transparent: return "thp";
+    case PagePolicy::HugeTlb: return "hugetlb";
+    default: return "small";
+    }
+}
+
+inline PagePolicy page_policy_from_name(const std::string& name, PagePolicy fallback) {
+    const PagePolicy all[] = {PagePolicy::Small, PagePolicy::Transparent, PagePolicy::HugeTlb};
+    for (PagePolicy p : all)
+        if (name == page_policy_name(p))
+            return p;
+    return fallback;
+}
+
+// Плотная матрица в построчном (row-major) порядке одним блоком памяти.
+// Начало блока и начало каждой строки выровнены на 64 байта (кэш-линия),
+// поэтому шаг между строками ld() может быть больше cols().
+template <typename T>
+class Matrix {
+public:
+    static const size_t alignment = 64;
+    static const size_t page_size = 4096;
+    static const size_t huge_page_size = 2 << 20;
+
+    Matrix() {}
+
+    // По умолчанию массивы от 2 МБ просят прозрачные huge pages: при n = 40000
+    // это ~6000 страниц вместо 3 млн и почти без промахов dTLB
+    Matrix(size_t rows, size_t cols, PagePolicy pages = PagePolicy::Transparent)
+        : rows_(rows), cols_(cols), ld_(padded(cols)) {
+        size_t bytes = rows_ * ld_ * sizeof(T);
+        if (bytes == 0)
+            return;
+        if (pages == PagePolicy::HugeTlb) {
+            alloc_bytes_ = round_up(bytes, huge_page_size);
+            void* p = ::mmap(nullptr, alloc_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<T*>(p);
+                pages_ = PagePolicy::HugeTlb;
+                return;
+            }
+            pages = PagePolicy::Transparent;
+        }
+        if (pages == PagePolicy::Transparent && bytes >= huge_page_size) {
+            alloc_bytes_ = round_up(bytes, huge_page_size);
+            data_ = static_cast<T*>(std::aligned_alloc(huge_page_size, alloc_bytes_));
+            if (!data_)
+                throw std::bad_alloc();
+            pages_ = ::madvise(data_, alloc_bytes_, MADV_HUGEPAGE) == 0 ? PagePolicy::Transparent : PagePolicy::Small;
+            return;
+        }
+        alloc_bytes_ = round_up(bytes, alignment);
+        data_ = static_cast<T*>(std::aligned_alloc(alignment, alloc_bytes_));
+        if (!data_)
+            throw std::bad_alloc();
+        pages_ = PagePolicy::Small;
+    }
+
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+
+    Matrix(Matrix&& other) noexcept { swap(other); }
+
+    Matrix& operator=(Matrix&& other) noexcept {
+        Matrix tmp(std::move(other));
+        swap(tmp);
+        return *this;
+    }
+
+    ~Matrix() {
+        if (pages_ == PagePolicy::HugeTlb)
+            ::munmap(data_, alloc_bytes_);
+        else
+            std::free(data_);
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t ld() const { return ld_; }
+    size_t bytes() const { return rows_ * ld_ * sizeof(T); }
+    // Какие страницы реально получены (с учётом отката)
+    PagePolicy pages() const { return pages_; }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    // Указатель на начало строки i: m.row(i)[j] или m[i][j]
+    T* row(size_t i) { return data_ + i * ld_; }
+    const T* row(size_t i) const { return data_ + i * ld_; }
+    T* operator[](size_t i) { return row(i); }
+    const T* operator[](size_t i) const { return row(i); }
+
+    T& operator()(size_t i, size_t j) { return data_[i * ld_ + j]; }
+    const T& operator()(size_t i, size_t j) const { return data_[i * ld_ + j]; }
+
+    // Память после конструктора не инициализирована и физически не выделена.
+    // Каждый поток касается по одному элементу на страницу в своих строках
+    // с тем же static-расписанием, что и вычислительные циклы, — страницы
+    // оказываются на NUMA-узле потока, который потом с ними работает.
+    void first_touch(int thread_numb) {
+        const size_t step = page_size / sizeof(T) ? page_size / sizeof(T) : 1;
+        const long n = (long)rows_;
+        #pragma omp parallel for schedule(static) num_threads(thread_numb)
+        for (long i = 0; i < n; i++) {
+            T* r = row(i);
+            for (size_t j = 0; j < ld_; j += step)
+                r[j] = T();
+            if (ld_)
+                r[ld_ - 1] = T();
+        }
+    }
+
+    void swap(Matrix& other) noexcept {
+        std::swap(rows_, other.rows_);
+        std::swap(cols_, other.cols_);
+        std::swap(ld_, other.ld_);
+        std::swap(data_, other.data_);
+        std::swap(pages_, other.pages_);
+        std::swap(alloc_bytes_, other.alloc_bytes_);
+    }
+
+private:
+    static size_t round_up(size_t x, size_t a) { return (x + a - 1) / a * a; }
+
+    // Дополняем строку до целого числа кэш-линий
+    static size_t padded(size_t cols) {
+        size_t per_line = alignment / sizeof(T);
+        return per_line ? round_up(cols, per_line) : cols;
+    }
+
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t ld_ = 0;
+    T* data_ = nullptr;
+    PagePolicy pages_ = PagePolicy::Small;
+    size_t alloc_bytes_ = 0;
+};
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "harness.h"
+
+// Аппаратные счётчики через perf_event_open(2), по одному набору на поток.
+// Если PMU недоступен (виртуалка, perf_event_paranoid), счётчики просто
+// не открываются, а task-clock (программный) работает почти всегда.
+
+enum PerfEvent {
+    PERF_TASK_CLOCK, PERF_CYCLES, PERF_INSTRUCTIONS, PERF_LLC_MISSES, PERF_STALLED_CYCLES, PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+};
+
+inline const char* perf_event_name(int e) {
+    static const char* names[PERF_EVENT_COUNT] = {"task-clock", "cycles", "instructions", "LLC-misses", "stalled-cycles",
+                                                  "dTLB-load-misses"};
+    return names[e];
+}
+
+struct PerfSample {
+    double value[PERF_EVENT_COUNT] = {};
+    bool valid[PERF_EVENT_COUNT] = {};
+
+    PerfSample& operator+=(const PerfSample& o) {
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            value[e] += o.value[e];
+            valid[e] = valid[e] || o.valid[e];
+        }
+        return *this;
+    }
+};
+
+inline pid_t current_tid() { return (pid_t)::syscall(SYS_gettid); }
+
+// Счётчики одного потока
+class ThreadCounters {
+public:
+    ThreadCounters() { std::fill(fd_, fd_ + PERF_EVENT_COUNT, -1); }
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+    ~ThreadCounters() { close(); }
+
+    // tid == 0 — вызывающий поток. false, если не открылся ни один счётчик
+    bool open(pid_t tid = 0) {
+        close();
+        static const uint32_t types[PERF_EVENT_COUNT] = {PERF_TYPE_SOFTWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                         PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+        static const uint64_t configs[PERF_EVENT_COUNT] = {
+            PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_STALLED_CYCLES_BACKEND,
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+        bool any = false;
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd_[e] = (int)::syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0);
+            if (fd_[e] >= 0)
+                any = true;
+            else if (error_.empty())
+                error_ = std::string(perf_event_name(e)) + ": " + std::strerror(errno);
+        }
+        return any;
+    }
+
+    void start() {
+        for (int fd : fd_)
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+    }
+
+    void stop() {
+        for (int fd : fd_)
+            if (fd >= 0)
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    // Значения с поправкой на мультиплексирование счётчиков
+    PerfSample read() const {
+        PerfSample s;
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            uint64_t buf[3];
+            if (fd_[e] < 0 || ::read(fd_[e], buf, sizeof(buf)) != (ssize_t)sizeof(buf))
+                continue;
+            s.valid[e] = true;
+            s.value[e] = buf[2] ? (double)buf[0] * buf[1] / buf[2] : 0.0;
+        }
+        return s;
+    }
+
+    void close() {
+        for (int& fd : fd_)
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+    }
+
+    // Причина, по которой не открылся первый из счётчиков
+    const std::string& error() const { return error_; }
+
+private:
+    int fd_[PERF_EVENT_COUNT];
+    std::string error_;
+};
+
+// Сводка по потокам: суммы событий, IPC, доля стоящих тактов и дисбаланс
+// (максимум task-clock по потокам к среднему). prefix — для нескольких фаз.
+inline void add_perf_metrics(BenchResult& r, const std::vector<PerfSample>& threads, double scale = 1.0,
+                             const std::string& prefix = "") {
+    PerfSample total;
+    double max_clock = 0;
+    for (const PerfSample& s : threads) {
+        total += s;
+        max_clock = std::max(max_clock, s.value[PERF_TASK_CLOCK]);
+    }
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+        if (total.valid[e])
+            r.metrics.push_back(std::make_pair(prefix + perf_event_name(e), total.value[e] * scale));
+    if (total.valid[PERF_CYCLES] && total.valid[PERF_INSTRUCTIONS] && total.value[PERF_CYCLES] > 0)
+        r.metrics.push_back(std::make_pair(prefix + "IPC", total.value[PERF_INSTRUCTIONS] / total.value[PERF_CYCLES]));
+    if (total.valid[PERF_CYCLES] && total.valid[PERF_STALLED_CYCLES] && total.value[PERF_CYCLES] > 0)
+        r.metrics.push_back(std::make_pair(prefix + "stalled", total.value[PERF_STALLED_CYCLES] / total.value[PERF_CYCLES]));
+    if (total.valid[PERF_INSTRUCTIONS] && total.valid[PERF_DTLB_MISSES] && total.value[PERF_INSTRUCTIONS] > 0)
+        r.metrics.push_back(std::make_pair(prefix + "dTLB-MPKI", 1000.0 * total.value[PERF_DTLB_MISSES] / total.value[PERF_INSTRUCTIONS]));
+    if (total.valid[PERF_TASK_CLOCK] && total.value[PERF_TASK_CLOCK] > 0 && !threads.empty())
+        r.metrics.push_back(std::make_pair(prefix + "imbalance", max_clock * threads.size() / total.value[PERF_TASK_CLOCK]));
+
+    std::ostringstream per_thread;
+    for (size_t i = 0; i < threads.size(); i++) {
+        const PerfSample& s = threads[i];
+        per_thread << (i ? "," : "") << s.value[s.valid[PERF_CYCLES] ? PERF_CYCLES : PERF_TASK_CLOCK] * scale;
+    }
+    r.tags.push_back(std::make_pair(prefix + (total.valid[PERF_CYCLES] ? "cycles/thread" : "task-clock/thread"), per_thread.str()));
+}
+
+// Счётчики на каждом потоке команды OpenMP: tid потоков пула собираются
+// пустым параллельным регионом того же размера — libgomp переиспользует
+// те же потоки в следующих регионах с тем же num_threads.
+class PerfProbe : public Probe {
+public:
+    void begin(int threads) override {
+        std::vector<pid_t> tids(threads, 0);
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(threads)
+        tids[omp_get_thread_num()] = current_tid();
+#else
+        tids.assign(1, current_tid());
+#endif
+        counters_.clear();
+        for (pid_t tid : tids) {
+            counters_.emplace_back(new ThreadCounters());
+            counters_.back()->open(tid);
+            if (error_.empty())
+                error_ = counters_.back()->error();
+        }
+        if (sum_.size() != counters_.size())
+            sum_.assign(counters_.size(), PerfSample());
+        for (auto& c : counters_)
+            c->start();
+    }
+
+    void end() override {
+        for (size_t i = 0; i < counters_.size(); i++) {
+            counters_[i]->stop();
+            sum_[i] += counters_[i]->read();
+        }
+        counters_.clear();
+        runs_++;
+    }
+
+    void report(BenchResult& r) override {
+        if (runs_)
+            add_perf_metrics(r, sum_, 1.0 / runs_);
+        bool any = false;
+        for (const PerfSample& s : sum_)
+            any = any || s.valid[PERF_CYCLES];
+        if (!any)
+            r.tags.push_back(std::make_pair("perf", error_.empty() ? std::string("unavailable") : "unavailable (" + error_ + ")"));
+        sum_.clear();
+        runs_ = 0;
+    }
+
+private:
+    std::vector<std::unique_ptr<ThreadCounters>> counters_;
+    std::vector<PerfSample> sum_;
+    std::string error_;
+    int runs_ = 0;
+};
+
+// Счётчики по фазам для потоков, которые создаёт сам замер (std::thread):
+// каждый рабочий поток открывает счётчики для себя на время своей части фазы.
+class PhaseProbe : public Probe {
+public:
+    explicit PhaseProbe(std::vector<std::string> phases) : names_(std::move(phases)), sum_(names_.size()) {}
+
+    // Вызывается из рабочего потока thread; разные потоки пишут в разные ячейки
+    template <typename F>
+    void measure(size_t phase, int thread, F f) {
+        if (!active_) {
+            f();
+            return;
+        }
+        ThreadCounters c;
+        c.open();
+        c.start();
+        f();
+        c.stop();
+        sum_[phase][thread] += c.read();
+    }
+
+    void begin(int threads) override {
+        active_ = true;
+        for (auto& s : sum_)
+            if ((int)s.size() != threads)
+                s.assign(threads, PerfSample());
+    }
+
+    void end() override {
+        active_ = false;
+        runs_++;
+    }
+
+    void report(BenchResult& r) override {
+        bool any = false;
+        for (size_t ph = 0; ph < names_.size(); ph++) {
+            if (runs_)
+                add_perf_metrics(r, sum_[ph], 1.0 / runs_, names_[ph] + ":");
+            for (const PerfSample& s : sum_[ph])
+                any = any || s.valid[PERF_CYCLES];
+            sum_[ph].clear();
+        }
+        if (!any)
+            r.tags.push_back(std::make_pair("perf", std::string("unavailable")));
+        runs_ = 0;
+    }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<std::vector<PerfSample>> sum_;
+    bool active_ = false;
+    int runs_ = 0;
+};
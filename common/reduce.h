@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+// Воспроизводимое суммирование: результат побитово один и тот же при любом
+// числе потоков и любом расписании. Слагаемые term(i) режутся на блоки
+// фиксированной длины REDUCE_BLOCK по индексу (а не по потокам), каждый блок
+// суммируется попарно, суммы блоков складываются по фиксированному дереву.
+// Попарная сумма даёт погрешность O(log n · eps) против O(n · eps) у цикла.
+
+const long REDUCE_BLOCK = 4096;
+
+// Попарная сумма term(i), i ∈ [i0, i1): короткие куски — прямым циклом
+template <typename F>
+double pairwise_sum(F& term, long i0, long i1) {
+    if (i1 - i0 <= 32) {
+        double s = 0.0;
+        for (long i = i0; i < i1; i++)
+            s += term(i);
+        return s;
+    }
+    const long mid = i0 + (i1 - i0) / 2;
+    return pairwise_sum(term, i0, mid) + pairwise_sum(term, mid, i1);
+}
+
+// Сумма v[0..n) по тому же дереву
+inline double tree_sum(const double* v, long n) {
+    auto at = [v](long i) { return v[i]; };
+    return pairwise_sum(at, 0, n);
+}
+
+// Воспроизводимая редукция внутри параллельного региона: sum() вызывают все
+// потоки команды (orphaned omp for), результат получает каждый.
+// Буфер под суммы блоков заводится заранее, до региона.
+class BlockReducer {
+public:
+    explicit BlockReducer(long n) : n_(n), partial_(std::max(1L, (n + REDUCE_BLOCK - 1) / REDUCE_BLOCK), 0.0) {}
+
+    template <typename F>
+    double sum(F term) {
+        const long blocks = (long)partial_.size();
+        #pragma omp for schedule(static)
+        for (long k = 0; k < blocks; k++)
+            partial_[k] = pairwise_sum(term, k * REDUCE_BLOCK, std::min(n_, (k + 1) * REDUCE_BLOCK));
+        // барьер omp for выше: все суммы блоков готовы; барьер single — total_ записан
+        #pragma omp single
+        total_ = tree_sum(partial_.data(), blocks);
+        return total_;
+    }
+
+private:
+    long n_;
+    std::vector<double> partial_;
+    double total_ = 0.0;
+};
+
+// То же отдельным параллельным регионом
+template <typename F>
+double reproducible_sum(long n, F term, int thread_numb) {
+    BlockReducer reducer(n);
+    double s = 0.0;
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        double local = reducer.sum(term);
+        #pragma omp master
+        s = local;
+    }
+    return s;
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include "cpu_features.h"
+
+// Векторные exp, sin, sqrt, pow над массивами: y[i] = f(x[i]).
+//
+// Алгоритм каждой функции записан один раз как скалярное ядро без ветвлений
+// (*_core ниже), а цикл `omp simd` в функциях с target("avx2,fma") /
+// target("avx512f") разворачивает его в 4 / 8 полос. Скалярный вариант — тот
+// же цикл под базовый SSE2. Аргументы вне рабочего диапазона ядра (NaN, inf,
+// переполнение, субнормальные результаты, огромные аргументы sin) пересчитываются
+// вторым проходом через libm, так что граничные значения совпадают с std::.
+//
+// Погрешность относительно libm (в ULP, проверяется `lab3/2/main --check-ulp`
+// на случайных аргументах; в скобках — измеренный максимум):
+//   vexp  ≤ 1 ULP                                    (1)
+//   vsin  ≤ 2 ULP при |x| ≤ 1e5, ≤ 1 ULP при |x| ≤ 10 (2 / 1); дальше — libm
+//   vsqrt   0 ULP — инструкция sqrtpd, корректное округление
+//   vpow  целые |y| ≤ 64: точно, если все степени x точно представимы (целые
+//         с результатом < 2^53), иначе ≤ 64 ULP (48);
+//         прочие y: ≤ 3·(1 + |y·ln x|) ULP — ошибка log x умножается на y (2.05·(1 + |y·ln x|))
+//
+// Округление сдвигом (VM_SHIFTER) требует строгой арифметики: с -ffast-math
+// компилятор вправе сократить (x + C) - C, поэтому vmath с ним не собирается.
+
+inline uint64_t vm_bits(double x) { uint64_t u; std::memcpy(&u, &x, sizeof(u)); return u; }
+inline double vm_double(uint64_t u) { double x; std::memcpy(&x, &u, sizeof(x)); return x; }
+
+// Округление до ближайшего целого сдвигом на 1.5·2^52: k — как double и как int64
+const double VM_SHIFTER = 6755399441055744.0;
+
+// c ? a : b через маски: ?: над double GCC не всегда превращает в blend, и цикл не векторизуется
+inline double vm_select(bool c, double a, double b) {
+    uint64_t m = (uint64_t)0 - (uint64_t)c;
+    return vm_double((vm_bits(a) & m) | (vm_bits(b) & ~m));
+}
+
+// exp на |x| ≤ 708: x = k·ln2 + r, |r| ≤ ln2/2, e^r — ряд Тейлора до r^13
+__attribute__((always_inline)) inline double exp_core(double x) {
+    const double log2e = 1.4426950408889634;
+    const double ln2_hi = 6.93147180369123816490e-01, ln2_lo = 1.90821492927058770002e-10;
+    double t = x * log2e + VM_SHIFTER;
+    int64_t k = (int64_t)(vm_bits(t) - vm_bits(VM_SHIFTER));
+    double kd = t - VM_SHIFTER;
+    double r = (x - kd * ln2_hi) - kd * ln2_lo;
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r * r + r;
+    return (1.0 + p) * vm_double((uint64_t)(k + 1023) << 52);
+}
+
+// sin на |x| ≤ 1e5: x = k·π/2 + r (π/2 из трёх частей по 33 бита — k·часть точно),
+// |r| ≤ π/4, затем sin r или cos r по четверти k mod 4 (коэффициенты из Cephes)
+__attribute__((always_inline)) inline double sin_core(double x) {
+    const double two_over_pi = 6.36619772367581382433e-01;
+    const double pio2_1 = 1.57079632673412561417e+00, pio2_2 = 6.07710050630396597660e-11;
+    const double pio2_3 = 2.02226624871116645580e-21, pio2_3t = 8.47842766036889956997e-32;
+    double t = x * two_over_pi + VM_SHIFTER;
+    int64_t k = (int64_t)(vm_bits(t) - vm_bits(VM_SHIFTER));
+    double kd = t - VM_SHIFTER;
+    double r = x - kd * pio2_1;
+    r = r - kd * pio2_2;
+    r = r - kd * pio2_3;
+    r = r - kd * pio2_3t;
+    double z = r * r;
+
+    double s = 1.58962301576546568060e-10;
+    s = s * z - 2.50507477628578072866e-8;
+    s = s * z + 2.75573136213857245213e-6;
+    s = s * z - 1.98412698295895385996e-4;
+    s = s * z + 8.33333333332211858878e-3;
+    s = s * z - 1.66666666666666307295e-1;
+    double sin_r = r + r * z * s;
+
+    double c = -1.13585365213876817300e-11;
+    c = c * z + 2.08757008419747316778e-9;
+    c = c * z - 2.75573141792967388112e-7;
+    c = c * z + 2.48015872888517045348e-5;
+    c = c * z - 1.38888888888730564116e-3;
+    c = c * z + 4.16666666666665929218e-2;
+    double hz = 0.5 * z;
+    double w = 1.0 - hz;
+    double cos_r = w + (((1.0 - w) - hz) + z * z * c);
+
+    double v = vm_select(k & 1, cos_r, sin_r);
+    return vm_double(vm_bits(v) ^ ((uint64_t)(k & 2) << 62));
+}
+
+// log для нормальных x > 0 (fdlibm): x = 2^e·m, m ∈ [√½, √2), log m через atanh
+__attribute__((always_inline)) inline double log_core(double x) {
+    const double ln2_hi = 6.93147180369123816490e-01, ln2_lo = 1.90821492927058770002e-10;
+    uint64_t u = vm_bits(x);
+    int64_t e = (int64_t)(u >> 52) - 1023;
+    double m = vm_double((u & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    bool big = m > 1.4142135623730951;
+    m = vm_select(big, 0.5 * m, m);
+    // int64 → double через сдвиг: cvtqq2pd есть только в AVX-512DQ
+    double ed = vm_double(vm_bits(VM_SHIFTER) + (uint64_t)(e + (int64_t)big)) - VM_SHIFTER;
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double w = z * z;
+    double t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+    double t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 + w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+    double R = t1 + t2;
+    double hfsq = 0.5 * f * f;
+    return ed * ln2_hi - ((hfsq - (s * (hfsq + R) + ed * ln2_lo)) - f);
+}
+
+// pow для конечных x > 0: целые |y| ≤ 64 — возведением в квадрат (7 шагов по битам),
+// остальные — exp(y·log x). При |y·log x| > 708 показатель в exp_core
+// переполнился бы и дал конечное неверное число — там возвращается NaN,
+// и vpow_fixup отдаёт элемент libm
+__attribute__((always_inline)) inline double pow_core(double x, double y) {
+    double ay = std::fabs(y);
+    double t = vm_select(ay <= 64.0, ay, 0.5) + VM_SHIFTER;
+    bool small_int = t - VM_SHIFTER == ay;
+    uint64_t e = vm_bits(t) - vm_bits(VM_SHIFTER);
+    double r = 1.0, base = x;
+    r *= vm_select(e & 1, base, 1.0);  base *= base;
+    r *= vm_select(e & 2, base, 1.0);  base *= base;
+    r *= vm_select(e & 4, base, 1.0);  base *= base;
+    r *= vm_select(e & 8, base, 1.0);  base *= base;
+    r *= vm_select(e & 16, base, 1.0); base *= base;
+    r *= vm_select(e & 32, base, 1.0); base *= base;
+    r *= vm_select(e & 64, base, 1.0);
+    r = vm_select(y < 0, 1.0 / r, r);
+    double p = y * log_core(x);
+    double g = vm_select(std::fabs(p) <= 708.0, exp_core(p), NAN);
+    return vm_select(small_int, r, g);
+}
+
+// Где ядро неприменимо — libm
+inline bool exp_in_range(double x) { return std::fabs(x) <= 708.0; }
+inline bool sin_in_range(double x) { return std::fabs(x) <= 1e5; }
+// z — результат pow_core; NaN (|y·log x| > 708) не проходит сравнения
+inline bool pow_in_range(double x, double y, double z) {
+    return x >= 2.2250738585072014e-308 && x <= 1.7976931348623157e308 && std::fabs(y) <= 1.7976931348623157e308 &&
+           z >= 2.2250738585072014e-308 && z <= 1e300;
+}
+
+inline void vexp_fixup(const double* x, double* y, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (!exp_in_range(x[i]))
+            y[i] = std::exp(x[i]);
+}
+inline void vsin_fixup(const double* x, double* y, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (!sin_in_range(x[i]))
+            y[i] = std::sin(x[i]);
+}
+inline void vpow_fixup(const double* x, const double* y, double* z, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (!pow_in_range(x[i], y[i], z[i]))
+            z[i] = std::pow(x[i], y[i]);
+}
+
+typedef void (*vmath1_fn)(const double* x, double* y, size_t n);
+typedef void (*vmath2_fn)(const double* x, const double* y, double* z, size_t n);
+
+struct VMathKernels {
+    Isa isa;
+    vmath1_fn exp;
+    vmath1_fn sin;
+    vmath1_fn sqrt;
+    vmath2_fn pow;
+};
+
+// Одинаковые тела циклов для всех наборов инструкций
+#define VMATH_LOOPS(suffix)                                                        \
+    inline void vexp_##suffix(const double* x, double* y, size_t n) {              \
+        _Pragma("omp simd") for (size_t i = 0; i < n; i++) y[i] = exp_core(x[i]);   \
+        vexp_fixup(x, y, n);                                                       \
+    }                                                                              \
+    inline void vsin_##suffix(const double* x, double* y, size_t n) {              \
+        _Pragma("omp simd") for (size_t i = 0; i < n; i++) y[i] = sin_core(x[i]);   \
+        vsin_fixup(x, y, n);                                                       \
+    }                                                                              \
+    inline void vpow_##suffix(const double* x, const double* y, double* z, size_t n) { \
+        _Pragma("omp simd") for (size_t i = 0; i < n; i++) z[i] = pow_core(x[i], y[i]); \
+        vpow_fixup(x, y, z, n);                                                    \
+    }
+
+VMATH_LOOPS(scalar)
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+VMATH_LOOPS(avx2)
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+VMATH_LOOPS(avx512)
+#pragma GCC pop_options
+
+#undef VMATH_LOOPS
+
+inline void vsqrt_scalar(const double* x, double* y, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        y[i] = std::sqrt(x[i]);
+}
+
+__attribute__((target("avx2")))
+inline void vsqrt_avx2(const double* x, double* y, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(y + i, _mm256_sqrt_pd(_mm256_loadu_pd(x + i)));
+    for (; i < n; i++)
+        y[i] = std::sqrt(x[i]);
+}
+
+__attribute__((target("avx512f")))
+inline void vsqrt_avx512(const double* x, double* y, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(y + i, _mm512_sqrt_pd(_mm512_loadu_pd(x + i)));
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_pd(y + i, m, _mm512_sqrt_pd(_mm512_maskz_loadu_pd(m, x + i)));
+    }
+}
+
+inline VMathKernels select_vmath_kernels(Isa isa) {
+    switch (isa) {
+    case Isa::Avx512: return {isa, vexp_avx512, vsin_avx512, vsqrt_avx512, vpow_avx512};
+    case Isa::Avx2: return {isa, vexp_avx2, vsin_avx2, vsqrt_avx2, vpow_avx2};
+    default: return {Isa::Scalar, vexp_scalar, vsin_scalar, vsqrt_scalar, vpow_scalar};
+    }
+}
+
+// Ядра под текущий процессор, выбираются один раз
+inline const VMathKernels& vmath() {
+    static const VMathKernels k = select_vmath_kernels(detect_isa());
+    return k;
+}
+
+inline void vexp(const double* x, double* y, size_t n) { vmath().exp(x, y, n); }
+inline void vsin(const double* x, double* y, size_t n) { vmath().sin(x, y, n); }
+inline void vsqrt(const double* x, double* y, size_t n) { vmath().sqrt(x, y, n); }
+inline void vpow(const double* x, const double* y, double* z, size_t n) { vmath().pow(x, y, z, n); }
+
+// Расстояние в ULP между двумя конечными double (для проверки точности)
+inline double ulp_distance(double a, double b) {
+    if (a == b)
+        return 0.0;
+    if (std::isnan(a) || std::isnan(b))
+        return std::isnan(a) && std::isnan(b) ? 0.0 : INFINITY;
+    int64_t ia = (int64_t)vm_bits(a), ib = (int64_t)vm_bits(b);
+    ia = ia < 0 ? INT64_MIN - ia : ia;
+    ib = ib < 0 ? INT64_MIN - ib : ib;
+    return ia > ib ? (double)(ia - ib) : (double)(ib - ia);
+}
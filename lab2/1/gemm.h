@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <immintrin.h>
+#include <omp.h>
+#include "cpu_features.h"
+#include "matrix.h"
+
+// DGEMM в духе BLIS: C = alpha * A * B + beta * C, все матрицы построчные
+// с шагом строк (Matrix::ld()). Пять вложенных циклов вокруг микроядра:
+//   jc по NC столбцам B → pc по KC (упаковка панели B: KC×NC, живёт в L3)
+//   → ic по MC строкам A (упаковка блока A: MC×KC, живёт в L2)
+//   → jr по NR → ir по MR → микроядро MR×NR на регистрах.
+
+// Микроядро: ab[MR][NR] = Σp a[p][0..MR) ⊗ b[p][0..NR) по упакованным панелям
+typedef void (*gemm_ukr_fn)(int kc, const double* a, const double* b, double* ab);
+
+struct GemmKernel {
+    Isa isa;
+    int mr, nr;
+    gemm_ukr_fn ukr;
+};
+
+// Размеры блоков: KC×NR панели B — в L1, MC×KC блока A — в L2
+const int GEMM_KC = 256;
+const int GEMM_MC = 96;
+const int GEMM_NC = 2048;
+
+inline void gemm_ukr_scalar(int kc, const double* a, const double* b, double* ab) {
+    double c[4][4] = {};
+    for (int p = 0; p < kc; p++, a += 4, b += 4)
+        for (int r = 0; r < 4; r++)
+            for (int q = 0; q < 4; q++)
+                c[r][q] += a[r] * b[q];
+    for (int r = 0; r < 4; r++)
+        for (int q = 0; q < 4; q++)
+            ab[r * 4 + q] = c[r][q];
+}
+
+// 6×8: 12 аккумуляторов ymm + 2 под строку B + 1 под a — из 16 регистров
+__attribute__((target("avx2,fma")))
+inline void gemm_ukr_avx2(int kc, const double* a, const double* b, double* ab) {
+    __m256d c[6][2];
+    for (int r = 0; r < 6; r++)
+        c[r][0] = c[r][1] = _mm256_setzero_pd();
+    for (int p = 0; p < kc; p++, a += 6, b += 8) {
+        const __m256d b0 = _mm256_load_pd(b), b1 = _mm256_load_pd(b + 4);
+        for (int r = 0; r < 6; r++) {
+            const __m256d av = _mm256_broadcast_sd(a + r);
+            c[r][0] = _mm256_fmadd_pd(av, b0, c[r][0]);
+            c[r][1] = _mm256_fmadd_pd(av, b1, c[r][1]);
+        }
+    }
+    for (int r = 0; r < 6; r++) {
+        _mm256_storeu_pd(ab + r * 8, c[r][0]);
+        _mm256_storeu_pd(ab + r * 8 + 4, c[r][1]);
+    }
+}
+
+// 6×16: 12 аккумуляторов zmm, на каждую загрузку a — две FMA
+__attribute__((target("avx512f")))
+inline void gemm_ukr_avx512(int kc, const double* a, const double* b, double* ab) {
+    __m512d c[6][2];
+    for (int r = 0; r < 6; r++)
+        c[r][0] = c[r][1] = _mm512_setzero_pd();
+    for (int p = 0; p < kc; p++, a += 6, b += 16) {
+        const __m512d b0 = _mm512_load_pd(b), b1 = _mm512_load_pd(b + 8);
+        for (int r = 0; r < 6; r++) {
+            const __m512d av = _mm512_set1_pd(a[r]);
+            c[r][0] = _mm512_fmadd_pd(av, b0, c[r][0]);
+            c[r][1] = _mm512_fmadd_pd(av, b1, c[r][1]);
+        }
+    }
+    for (int r = 0; r < 6; r++) {
+        _mm512_storeu_pd(ab + r * 16, c[r][0]);
+        _mm512_storeu_pd(ab + r * 16 + 8, c[r][1]);
+    }
+}
+
+inline GemmKernel select_gemm_kernel(Isa isa) {
+    switch (isa) {
+    case Isa::Avx512: return {isa, 6, 16, gemm_ukr_avx512};
+    case Isa::Avx2: return {isa, 6, 8, gemm_ukr_avx2};
+    default: return {Isa::Scalar, 4, 4, gemm_ukr_scalar};
+    }
+}
+
+// Пиковая производительность на ядро в FLOP за такт (двойная точность, два порта FMA).
+// Скалярное ядро компилятор всё равно векторизует под базовый для x86-64 SSE2:
+// сложение и умножение по 2 double за такт
+inline int gemm_flops_per_cycle(Isa isa) {
+    switch (isa) {
+    case Isa::Avx512: return 32;
+    case Isa::Avx2: return 16;
+    default: return 4;
+    }
+}
+
+// Блок A (mc×kc) → панели по mr строк: для каждого p подряд mr значений.
+// Неполная последняя панель добивается нулями.
+inline void gemm_pack_a(int mc, int kc, const double* A, size_t lda, int mr, double* dst) {
+    for (int i0 = 0; i0 < mc; i0 += mr) {
+        const int rows = std::min(mr, mc - i0);
+        for (int p = 0; p < kc; p++) {
+            for (int r = 0; r < rows; r++)
+                dst[r] = A[(i0 + r) * lda + p];
+            for (int r = rows; r < mr; r++)
+                dst[r] = 0.0;
+            dst += mr;
+        }
+    }
+}
+
+// Панель B (kc×nr, начиная со столбца j0) → для каждого p подряд nr значений
+inline void gemm_pack_b_panel(int kc, int cols, const double* B, size_t ldb, int nr, double* dst) {
+    for (int p = 0; p < kc; p++) {
+        const double* src = B + p * ldb;
+        for (int q = 0; q < cols; q++)
+            dst[q] = src[q];
+        for (int q = cols; q < nr; q++)
+            dst[q] = 0.0;
+        dst += nr;
+    }
+}
+
+// Потоки делят между собой упаковку панелей B (по nr столбцов) и блоки
+// строк A по MC; каждый поток пакует свой блок A в личный буфер.
+// Панель B общая, поэтому между шагами pc — барьеры (неявные у omp for).
+inline void dgemm(const GemmKernel& k, int m, int n, int kdim, double alpha, const double* A, size_t lda,
+                  const double* B, size_t ldb, double beta, double* C, size_t ldc, int thread_numb) {
+    const int mr = k.mr, nr = k.nr;
+    const int nc_max = std::min(GEMM_NC, (n + nr - 1) / nr * nr);
+    const int kc_max = std::min(GEMM_KC, std::max(kdim, 1));
+    Matrix<double> bpack(1, (size_t)nc_max * kc_max, PagePolicy::Small);
+
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        const int mc_max = GEMM_MC / mr * mr;
+        Matrix<double> apack(1, (size_t)mc_max * kc_max, PagePolicy::Small);
+        double ab[16 * 16];
+
+        for (int jc = 0; jc < n; jc += nc_max) {
+            const int nc = std::min(nc_max, n - jc);
+            const int panels = (nc + nr - 1) / nr;
+            for (int pc = 0; pc == 0 || pc < kdim; pc += kc_max) {
+                const int kc = std::min(kc_max, kdim - pc);
+                // beta применяется только на первом шаге по k, дальше накапливаем
+                const double beta_pc = pc == 0 ? beta : 1.0;
+
+                #pragma omp for schedule(static)
+                for (int jp = 0; jp < panels; jp++) {
+                    const int j0 = jp * nr;
+                    gemm_pack_b_panel(kc, std::min(nr, nc - j0), B + pc * ldb + jc + j0, ldb, nr,
+                                      bpack.data() + (size_t)jp * nr * kc);
+                }
+
+                #pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += mc_max) {
+                    const int mc = std::min(mc_max, m - ic);
+                    gemm_pack_a(mc, kc, A + ic * lda + pc, lda, mr, apack.data());
+                    for (int jp = 0; jp < panels; jp++) {
+                        const int j0 = jp * nr, cols = std::min(nr, nc - j0);
+                        const double* bp = bpack.data() + (size_t)jp * nr * kc;
+                        for (int i0 = 0; i0 < mc; i0 += mr) {
+                            const int rows = std::min(mr, mc - i0);
+                            k.ukr(kc, apack.data() + (size_t)i0 * kc, bp, ab);
+                            for (int r = 0; r < rows; r++) {
+                                double* c = C + (ic + i0 + r) * ldc + jc + j0;
+                                for (int q = 0; q < cols; q++)
+                                    c[q] = alpha * ab[r * nr + q] + (beta_pc == 0.0 ? 0.0 : beta_pc * c[q]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Эталон для сверки: тройной цикл i-p-j
+inline void dgemm_naive(int m, int n, int kdim, double alpha, const double* A, size_t lda, const double* B, size_t ldb,
+                        double beta, double* C, size_t ldc, int rows, int thread_numb) {
+    #pragma omp parallel for schedule(static) num_threads(thread_numb)
+    for (int i = 0; i < std::min(m, rows); i++) {
+        double* c = C + i * ldc;
+        for (int j = 0; j < n; j++)
+            c[j] = beta == 0.0 ? 0.0 : beta * c[j];
+        for (int p = 0; p < kdim; p++) {
+            const double a = alpha * A[i * lda + p];
+            for (int j = 0; j < n; j++)
+                c[j] += a * B[p * ldb + j];
+        }
+    }
+}
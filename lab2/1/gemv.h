@@ -0,0 +1,226 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <immintrin.h>
+#include <omp.h>
+#include "cpu_features.h"
+
+// DGEMV: y = alpha * op(A) * x + beta * y, op(A) = A или Aᵀ.
+// A — m×n в построчном порядке с шагом строк lda (как Matrix::ld()),
+// x и y — с шагами incx, incy (> 0).
+
+enum class Trans { No, Yes };
+
+// Блок из 4 строк: каждый загруженный кусок x (или y) используется
+// четырьмя строками, а не одной
+typedef void (*dot4_fn)(const double* a, size_t lda, const double* x, int n, double* out);   // out[r] = a_r · x
+typedef void (*axpy4_fn)(const double* a, size_t lda, const double* c, double* y, int n);   // y += Σ c[r] * a_r
+
+struct GemvKernels {
+    Isa isa;
+    dot4_fn dot4;
+    axpy4_fn axpy4;
+};
+
+inline void dot4_scalar(const double* a, size_t lda, const double* x, int n, double* out) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int j = 0; j < n; j++) {
+        s0 += a0[j] * x[j];
+        s1 += a1[j] * x[j];
+        s2 += a2[j] * x[j];
+        s3 += a3[j] * x[j];
+    }
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+}
+
+inline void axpy4_scalar(const double* a, size_t lda, const double* c, double* y, int n) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    for (int j = 0; j < n; j++)
+        y[j] += c[0] * a0[j] + c[1] * a1[j] + c[2] * a2[j] + c[3] * a3[j];
+}
+
+__attribute__((target("avx2,fma")))
+inline double hsum_avx2(__m256d v) {
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+__attribute__((target("avx2,fma")))
+inline void dot4_avx2(const double* a, size_t lda, const double* x, int n, double* out) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m256d xv = _mm256_loadu_pd(x + j);
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + j), xv, s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + j), xv, s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + j), xv, s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + j), xv, s3);
+    }
+    out[0] = hsum_avx2(s0); out[1] = hsum_avx2(s1); out[2] = hsum_avx2(s2); out[3] = hsum_avx2(s3);
+    for (; j < n; j++) {
+        out[0] += a0[j] * x[j];
+        out[1] += a1[j] * x[j];
+        out[2] += a2[j] * x[j];
+        out[3] += a3[j] * x[j];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline void axpy4_avx2(const double* a, size_t lda, const double* c, double* y, int n) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    const __m256d c0 = _mm256_set1_pd(c[0]), c1 = _mm256_set1_pd(c[1]);
+    const __m256d c2 = _mm256_set1_pd(c[2]), c3 = _mm256_set1_pd(c[3]);
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m256d yv = _mm256_loadu_pd(y + j);
+        yv = _mm256_fmadd_pd(c0, _mm256_loadu_pd(a0 + j), yv);
+        yv = _mm256_fmadd_pd(c1, _mm256_loadu_pd(a1 + j), yv);
+        yv = _mm256_fmadd_pd(c2, _mm256_loadu_pd(a2 + j), yv);
+        yv = _mm256_fmadd_pd(c3, _mm256_loadu_pd(a3 + j), yv);
+        _mm256_storeu_pd(y + j, yv);
+    }
+    for (; j < n; j++)
+        y[j] += c[0] * a0[j] + c[1] * a1[j] + c[2] * a2[j] + c[3] * a3[j];
+}
+
+__attribute__((target("avx512f")))
+inline void dot4_avx512(const double* a, size_t lda, const double* x, int n, double* out) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    __m512d s0 = _mm512_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m512d xv = _mm512_loadu_pd(x + j);
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a0 + j), xv, s0);
+        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(a1 + j), xv, s1);
+        s2 = _mm512_fmadd_pd(_mm512_loadu_pd(a2 + j), xv, s2);
+        s3 = _mm512_fmadd_pd(_mm512_loadu_pd(a3 + j), xv, s3);
+    }
+    if (j < n) {
+        __mmask8 m = (__mmask8)((1u << (n - j)) - 1);
+        __m512d xv = _mm512_maskz_loadu_pd(m, x + j);
+        s0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a0 + j), xv, s0);
+        s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a1 + j), xv, s1);
+        s2 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a2 + j), xv, s2);
+        s3 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a3 + j), xv, s3);
+    }
+    out[0] = _mm512_reduce_add_pd(s0); out[1] = _mm512_reduce_add_pd(s1);
+    out[2] = _mm512_reduce_add_pd(s2); out[3] = _mm512_reduce_add_pd(s3);
+}
+
+__attribute__((target("avx512f")))
+inline void axpy4_avx512(const double* a, size_t lda, const double* c, double* y, int n) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    const __m512d c0 = _mm512_set1_pd(c[0]), c1 = _mm512_set1_pd(c[1]);
+    const __m512d c2 = _mm512_set1_pd(c[2]), c3 = _mm512_set1_pd(c[3]);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m512d yv = _mm512_loadu_pd(y + j);
+        yv = _mm512_fmadd_pd(c0, _mm512_loadu_pd(a0 + j), yv);
+        yv = _mm512_fmadd_pd(c1, _mm512_loadu_pd(a1 + j), yv);
+        yv = _mm512_fmadd_pd(c2, _mm512_loadu_pd(a2 + j), yv);
+        yv = _mm512_fmadd_pd(c3, _mm512_loadu_pd(a3 + j), yv);
+        _mm512_storeu_pd(y + j, yv);
+    }
+    if (j < n) {
+        __mmask8 m = (__mmask8)((1u << (n - j)) - 1);
+        __m512d yv = _mm512_maskz_loadu_pd(m, y + j);
+        yv = _mm512_fmadd_pd(c0, _mm512_maskz_loadu_pd(m, a0 + j), yv);
+        yv = _mm512_fmadd_pd(c1, _mm512_maskz_loadu_pd(m, a1 + j), yv);
+        yv = _mm512_fmadd_pd(c2, _mm512_maskz_loadu_pd(m, a2 + j), yv);
+        yv = _mm512_fmadd_pd(c3, _mm512_maskz_loadu_pd(m, a3 + j), yv);
+        _mm512_mask_storeu_pd(y + j, m, yv);
+    }
+}
+
+// Для SSE2 отдельных ядер нет: FMA появляется только вместе с AVX2
+inline GemvKernels select_gemv_kernels(Isa isa) {
+    switch (isa) {
+    case Isa::Avx512: return {isa, dot4_avx512, axpy4_avx512};
+    case Isa::Avx2: return {isa, dot4_avx2, axpy4_avx2};
+    default: return {Isa::Scalar, dot4_scalar, axpy4_scalar};
+    }
+}
+
+// Наивный вариант: по одной строке (для Aᵀ — по одному столбцу с шагом lda)
+inline void dgemv_naive(Trans trans, int m, int n, double alpha, const double* A, size_t lda, const double* x, int incx,
+                        double beta, double* y, int incy, int thread_numb) {
+    const int len = trans == Trans::No ? m : n;
+    #pragma omp parallel for schedule(static) num_threads(thread_numb)
+    for (int i = 0; i < len; i++) {
+        double s = 0;
+        if (trans == Trans::No)
+            for (int j = 0; j < n; j++)
+                s += A[i * lda + j] * x[(size_t)j * incx];
+        else
+            for (int j = 0; j < m; j++)
+                s += A[j * lda + i] * x[(size_t)j * incx];
+        double& yi = y[(size_t)i * incy];
+        yi = alpha * s + (beta == 0.0 ? 0.0 : beta * yi);
+    }
+}
+
+// Блочный вариант. Векторы с шагом сначала упаковываются в плотные буферы.
+//   y = A x:  строки делятся между потоками блоками по 4, x читается один раз на 4 строки;
+//   y = Aᵀ x: каждый поток владеет полосой столбцов y и проходит по всем строкам
+//             блоками по 4 — без редукции между потоками и без чтения A по столбцам.
+inline void dgemv(const GemvKernels& k, Trans trans, int m, int n, double alpha, const double* A, size_t lda,
+                  const double* x, int incx, double beta, double* y, int incy, int thread_numb) {
+    const int xlen = trans == Trans::No ? n : m;
+    const int ylen = trans == Trans::No ? m : n;
+    std::vector<double> xbuf;
+    if (incx != 1) {
+        xbuf.resize(xlen);
+        for (int j = 0; j < xlen; j++)
+            xbuf[j] = x[(size_t)j * incx];
+        x = xbuf.data();
+    }
+    auto store = [&](int i, double s) {
+        double& yi = y[(size_t)i * incy];
+        yi = alpha * s + (beta == 0.0 ? 0.0 : beta * yi);
+    };
+
+    if (trans == Trans::No) {
+        const int blocks = m / 4;
+        #pragma omp parallel num_threads(thread_numb)
+        {
+            #pragma omp for schedule(static)
+            for (int ib = 0; ib < blocks; ib++) {
+                double s[4];
+                k.dot4(A + (size_t)4 * ib * lda, lda, x, n, s);
+                for (int r = 0; r < 4; r++)
+                    store(4 * ib + r, s[r]);
+            }
+            #pragma omp for schedule(static)
+            for (int i = 4 * blocks; i < m; i++) {
+                double s = 0;
+                for (int j = 0; j < n; j++)
+                    s += A[i * lda + j] * x[j];
+                store(i, s);
+            }
+        }
+        return;
+    }
+
+    std::vector<double> acc(ylen, 0.0);
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        // Полосы выровнены на кэш-линию, чтобы потоки не делили строки acc
+        const int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        const int j0 = std::min(ylen, (int)((long)ylen * t / nt + 7) / 8 * 8);
+        const int j1 = t + 1 == nt ? ylen : std::min(ylen, (int)((long)ylen * (t + 1) / nt + 7) / 8 * 8);
+        if (j0 < j1) {
+            double* yb = acc.data() + j0;
+            int i = 0;
+            for (; i + 4 <= m; i += 4)
+                k.axpy4(A + i * lda + j0, lda, x + i, yb, j1 - j0);
+            for (; i < m; i++)
+                for (int j = j0; j < j1; j++)
+                    acc[j] += x[i] * A[i * lda + j];
+            for (int j = j0; j < j1; j++)
+                store(j, acc[j]);
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <immintrin.h>
+#include "cpu_features.h"
+
+// Ядра для одной строки матрицы из run_parallel.
+// Строка выровнена на 64 байта (Matrix), вектор b — произвольно.
+typedef void (*init_row_fn)(double* row, int n, int i);            // row[j] = i + j
+typedef void (*scale_row_fn)(double* row, const double* b, int n); // row[j] *= b[j]
+typedef void (*fused_row_fn)(double* row, int n, int i);           // row[j] = (i + j) * j
+
+struct RowKernels {
+    Isa isa;
+    init_row_fn init_row;
+    scale_row_fn scale_row;
+    fused_row_fn fused_row;
+};
+
+inline void init_row_scalar(double* row, int n, int i) {
+    for (int j = 0; j < n; j++)
+        row[j] = i + j;
+}
+
+inline void scale_row_scalar(double* row, const double* b, int n) {
+    for (int j = 0; j < n; j++)
+        row[j] *= b[j];
+}
+
+// Слитый проход при b[j] = j. Векторные версии пишут потоковыми (non-temporal)
+// записями мимо кэша: строка не читается перед записью (нет write-allocate)
+inline void fused_row_scalar(double* row, int n, int i) {
+    for (int j = 0; j < n; j++)
+        row[j] = (double)(i + j) * j;
+}
+
+__attribute__((target("sse2")))
+inline void init_row_sse2(double* row, int n, int i) {
+    __m128d v = _mm_setr_pd(i, i + 1.0);
+    const __m128d step = _mm_set1_pd(2.0);
+    int j = 0;
+    for (; j + 2 <= n; j += 2) {
+        _mm_store_pd(row + j, v);
+        v = _mm_add_pd(v, step);
+    }
+    for (; j < n; j++)
+        row[j] = i + j;
+}
+
+__attribute__((target("sse2")))
+inline void scale_row_sse2(double* row, const double* b, int n) {
+    int j = 0;
+    for (; j + 2 <= n; j += 2)
+        _mm_store_pd(row + j, _mm_mul_pd(_mm_load_pd(row + j), _mm_loadu_pd(b + j)));
+    for (; j < n; j++)
+        row[j] *= b[j];
+}
+
+__attribute__((target("sse2")))
+inline void fused_row_sse2(double* row, int n, int i) {
+    __m128d jv = _mm_setr_pd(0.0, 1.0);
+    const __m128d iv = _mm_set1_pd(i);
+    const __m128d step = _mm_set1_pd(2.0);
+    int j = 0;
+    for (; j + 2 <= n; j += 2) {
+        _mm_stream_pd(row + j, _mm_mul_pd(_mm_add_pd(iv, jv), jv));
+        jv = _mm_add_pd(jv, step);
+    }
+    for (; j < n; j++)
+        row[j] = (double)(i + j) * j;
+    _mm_sfence();
+}
+
+__attribute__((target("avx2")))
+inline void init_row_avx2(double* row, int n, int i) {
+    __m256d v = _mm256_setr_pd(i, i + 1.0, i + 2.0, i + 3.0);
+    const __m256d step = _mm256_set1_pd(4.0);
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        _mm256_store_pd(row + j, v);
+        v = _mm256_add_pd(v, step);
+    }
+    for (; j < n; j++)
+        row[j] = i + j;
+}
+
+__attribute__((target("avx2")))
+inline void scale_row_avx2(double* row, const double* b, int n) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256d r0 = _mm256_mul_pd(_mm256_load_pd(row + j), _mm256_loadu_pd(b + j));
+        __m256d r1 = _mm256_mul_pd(_mm256_load_pd(row + j + 4), _mm256_loadu_pd(b + j + 4));
+        _mm256_store_pd(row + j, r0);
+        _mm256_store_pd(row + j + 4, r1);
+    }
+    for (; j < n; j++)
+        row[j] *= b[j];
+}
+
+__attribute__((target("avx2")))
+inline void fused_row_avx2(double* row, int n, int i) {
+    __m256d jv = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+    const __m256d iv = _mm256_set1_pd(i);
+    const __m256d step = _mm256_set1_pd(4.0);
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        _mm256_stream_pd(row + j, _mm256_mul_pd(_mm256_add_pd(iv, jv), jv));
+        jv = _mm256_add_pd(jv, step);
+    }
+    for (; j < n; j++)
+        row[j] = (double)(i + j) * j;
+    _mm_sfence();
+}
+
+__attribute__((target("avx512f")))
+inline void init_row_avx512(double* row, int n, int i) {
+    __m512d v = _mm512_add_pd(_mm512_set1_pd(i), _mm512_setr_pd(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m512d step = _mm512_set1_pd(8.0);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        _mm512_store_pd(row + j, v);
+        v = _mm512_add_pd(v, step);
+    }
+    if (j < n)
+        _mm512_mask_store_pd(row + j, (__mmask8)((1u << (n - j)) - 1), v);
+}
+
+__attribute__((target("avx512f")))
+inline void scale_row_avx512(double* row, const double* b, int n) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm512_store_pd(row + j, _mm512_mul_pd(_mm512_load_pd(row + j), _mm512_loadu_pd(b + j)));
+    if (j < n) {
+        __mmask8 m = (__mmask8)((1u << (n - j)) - 1);
+        __m512d r = _mm512_mul_pd(_mm512_maskz_load_pd(m, row + j), _mm512_maskz_loadu_pd(m, b + j));
+        _mm512_mask_store_pd(row + j, m, r);
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void fused_row_avx512(double* row, int n, int i) {
+    __m512d jv = _mm512_setr_pd(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512d iv = _mm512_set1_pd(i);
+    const __m512d step = _mm512_set1_pd(8.0);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        _mm512_stream_pd(row + j, _mm512_mul_pd(_mm512_add_pd(iv, jv), jv));
+        jv = _mm512_add_pd(jv, step);
+    }
+    for (; j < n; j++)
+        row[j] = (double)(i + j) * j;
+    _mm_sfence();
+}
+
+inline RowKernels select_row_kernels(Isa isa) {
+    switch (isa) {
+    case Isa::Avx512: return {isa, init_row_avx512, scale_row_avx512, fused_row_avx512};
+    case Isa::Avx2: return {isa, init_row_avx2, scale_row_avx2, fused_row_avx2};
+    case Isa::Sse2: return {isa, init_row_sse2, scale_row_sse2, fused_row_sse2};
+    default: return {Isa::Scalar, init_row_scalar, scale_row_scalar, fused_row_scalar};
+    }
+}
@@ -1,48 +1,332 @@
 #include <iostream>
 #include <omp.h>
 #include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include "matrix.h"
+#include "kernels.h"
+#include "gemv.h"
+#include "gemm.h"
+#include "mapped_matrix.h"
+#include "lowrank.h"
+#include "harness.h"
+#include "perf_counters.h"
+#include "affinity.h"
 
+// Два прохода (запись i + j, затем умножение на b[j]) или один слитый
+enum class Mode { TwoPass, Fused };
 
-double run_parallel(int n, int thread_numb, std::vector<std::vector<double>>& a, std::vector<double>& b) {  
-    double t = omp_get_wtime();  
-    #pragma omp parallel num_threads(thread_numb) 
+// Объём трафика памяти за один run_parallel: в двух проходах запись,
+// затем чтение и запись; в слитом — только потоковая запись
+double traffic_bytes(int n, Mode mode = Mode::TwoPass) {
+    return (mode == Mode::Fused ? 1.0 : 3.0) * n * (double)n * sizeof(double);
+}
+
+// Исходный вариант на vector<vector<double>>: каждая строка — отдельный блок в куче
+double run_parallel_nested(int n, int thread_numb, std::vector<std::vector<double>>& a, std::vector<double>& b) {
+    double t = omp_get_wtime();
+    #pragma omp parallel num_threads(thread_numb)
     {
-        #pragma omp for 
+        #pragma omp for
         for (int i = 0; i < n; i++) {
             for (int j = 0; j < n; j++)
                 a[i][j] = i + j;
             b[i] = i;
         }
     }
-    #pragma omp parallel num_threads(thread_numb) 
+    #pragma omp parallel num_threads(thread_numb)
     {
         #pragma omp for schedule(guided)
-        for (int i = 0; i < n; i++) 
-            for (int j = 0; j < n; j++) 
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
                 a[i][j] *= b[j];
     }
     t = omp_get_wtime() - t;
-    
+
+    return t;
+}
+
+double run_parallel(int n, int thread_numb, Matrix<double>& a, std::vector<double>& b, const RowKernels& k, Mode mode = Mode::TwoPass) {
+    double t = omp_get_wtime();
+    if (mode == Mode::Fused) {
+        // b[j] = j известно заранее, поэтому a[i][j] = (i + j) * j пишется за один проход
+        #pragma omp parallel for schedule(static) num_threads(thread_numb)
+        for (int i = 0; i < n; i++) {
+            k.fused_row(a.row(i), n, i);
+            b[i] = i;
+        }
+        return omp_get_wtime() - t;
+    }
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        #pragma omp for
+        for (int i = 0; i < n; i++) {
+            k.init_row(a.row(i), n, i);
+            b[i] = i;
+        }
+    }
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        // static, как и при first_touch: поток обрабатывает строки со своего NUMA-узла
+        #pragma omp for schedule(static)
+        for (int i = 0; i < n; i++)
+            k.scale_row(a.row(i), b.data(), n);
+    }
+    t = omp_get_wtime() - t;
+
+    return t;
+}
+
+// Та же задача на матрице в файле: init и умножение на b[j] делаются
+// по тайлам, в памяти одновременно не больше окна из двух тайлов.
+// В io_bytes возвращается объём данных, прошедших через диск.
+double run_parallel_mapped(int n, int thread_numb, MappedMatrix<double>& a, std::vector<double>& b, const RowKernels& k,
+                           size_t window_bytes, double& io_bytes) {
+    double t = omp_get_wtime();
+    for (int i = 0; i < n; i++)
+        b[i] = i;
+    io_bytes = for_each_tile(a, tile_rows_for(a, window_bytes), true, [&](size_t r0, size_t r1) {
+        #pragma omp parallel for schedule(static) num_threads(thread_numb)
+        for (long i = (long)r0; i < (long)r1; i++) {
+            k.init_row(a.row(i), n, (int)i);
+            k.scale_row(a.row(i), b.data(), n);
+        }
+    });
+    t = omp_get_wtime() - t;
+
     return t;
 }
 
+// Та же задача на множителях: a[i][j] = i + j = U·Vᵀ с U = [i, 1], V = [1, j],
+// затем умножение столбцов на b[j] = j. O(n) памяти и времени
+double run_parallel_lowrank(int n, int thread_numb, LowRankMatrix& a, std::vector<double>& b) {
+    double t = omp_get_wtime();
+    #pragma omp parallel for schedule(static) num_threads(thread_numb)
+    for (int i = 0; i < n; i++) {
+        a.d()[i] = 0.0;
+        a.U()(i, 0) = i;
+        a.U()(i, 1) = 1.0;
+        a.V()(i, 0) = 1.0;
+        a.V()(i, 1) = i;
+        b[i] = i;
+    }
+    a.scale_columns(b.data(), thread_numb);
+    return omp_get_wtime() - t;
+}
+
+// Тактовая частота для оценки пика, ГГц: cpufreq, иначе "cpu MHz" из /proc/cpuinfo
+double cpu_ghz() {
+    std::ifstream f("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+    double khz;
+    if (f >> khz)
+        return khz / 1e6;
+    std::ifstream info("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(info, line))
+        if (line.compare(0, 7, "cpu MHz") == 0)
+            return std::stod(line.substr(line.find(':') + 1)) / 1e3;
+    return 0;
+}
+
 int main (int argc, char** argv) {
-    int sizes[2] = {20000, 40000};
-    int n;
-    int numbers[8] = {1, 2,4,7,8,16,20,40};
-
-    for(int j = 0; j < 2; j++) {
-        n = sizes[j];
-        std::vector<std::vector<double>> a(n, std::vector<double>(n));
-        std::vector<double> b(n);
-        if (j == 0) std::cout << "For 20000 size: " << std::endl;
-        else std::cout << "For 40000 size: " << std::endl;
-        double T1 = run_parallel(n, 1, a, b);
-        std::cout << "T1 = " << T1 << std::endl;
-        for(int i = 1; i < 8; i++) {
-            double TN = run_parallel(n, numbers[i], a, b);
-            double S = T1/TN;
-            std::cout << "T" << numbers[i] << " = " << TN << " S" << numbers[i] << " = " << S << std::endl;
+    Harness h(argc, argv, {20000, 40000}, {1, 2, 4, 7, 8, 16, 20, 40});
+    // --perf: счётчики каждого потока OpenMP вокруг каждого замера
+    PerfProbe perf;
+    if (h.flag("perf"))
+        h.probe(&perf);
+    // --affinity: перебор политик привязки потоков
+    add_affinity_sweep(h);
+    const int max_threads = *std::max_element(h.threads().begin(), h.threads().end());
+
+    // Ядра выбираются один раз по CPUID; --isa sse2 — принудительно более слабый набор
+    Isa isa = detect_isa();
+    if (isa_from_name(h.option("isa", "").c_str(), isa) < isa)
+        isa = isa_from_name(h.option("isa", "").c_str(), isa);
+    const RowKernels kernels = select_row_kernels(isa);
+    std::cout << "ISA = " << isa_name(kernels.isa) << std::endl;
+
+    // Исходная раскладка vector<vector<double>>
+    h.add("nested", [&](long n) {
+        auto a = std::make_shared<std::vector<std::vector<double>>>(n, std::vector<double>(n));
+        auto b = std::make_shared<std::vector<double>>(n);
+        Case c;
+        c.run = [=](int threads) { return run_parallel_nested(n, threads, *a, *b); };
+        c.rates = {{"GB/s", traffic_bytes(n) / 1e9}};
+        return c;
+    });
+    // Matrix: два прохода и слитый проход.
+    // --pages small,thp,hugetlb — те же ядра на разных страницах (с --perf видны промахи dTLB)
+    const std::vector<std::string> pages = h.list("pages", "thp");
+    for (const std::string& page : pages) {
+        const PagePolicy policy = page_policy_from_name(page, PagePolicy::Transparent);
+        for (Mode mode : {Mode::TwoPass, Mode::Fused}) {
+            std::string name = mode == Mode::Fused ? "fused" : "matrix";
+            h.add(pages.size() > 1 ? name + "/" + page : name, [&, mode, policy](long n) {
+                auto a = std::make_shared<Matrix<double>>(n, n, policy);
+                auto b = std::make_shared<std::vector<double>>(n);
+                a->first_touch(max_threads);
+                Case c;
+                c.run = [=, &kernels](int threads) { return run_parallel(n, threads, *a, *b, kernels, mode); };
+                c.rates = {{"GB/s", traffic_bytes(n, mode) / 1e9}};
+                c.tags = {{"isa", isa_name(kernels.isa)}, {"pages", page_policy_name(a->pages())}};
+                return c;
+            });
         }
     }
-}
\ No newline at end of file
+    // DGEMV на матрице a[i][j] = (i + j) * j: наивный цикл по строкам и блочный движок.
+    // --alpha, --beta, --incx, --incy — параметры вызова; для Aᵀ — суффикс T
+    const GemvKernels gemv_kernels = select_gemv_kernels(isa);
+    const double alpha = h.option("alpha", 1.0), beta = h.option("beta", 0.0);
+    const int incx = std::max(1, h.option("incx", 1)), incy = std::max(1, h.option("incy", 1));
+    for (Trans trans : {Trans::No, Trans::Yes}) {
+        for (bool naive : {true, false}) {
+            std::string name = std::string(trans == Trans::No ? "gemv" : "gemvT") + (naive ? "-naive" : "");
+            h.add(name, [&, trans, naive](long n) {
+                auto a = std::make_shared<Matrix<double>>(n, n);
+                auto x = std::make_shared<std::vector<double>>((size_t)n * incx);
+                auto y = std::make_shared<std::vector<double>>((size_t)n * incy, 1.0);
+                a->first_touch(max_threads);
+                std::vector<double> b(n);
+                run_parallel(n, max_threads, *a, b, kernels, Mode::Fused);
+                for (long j = 0; j < n; j++)
+                    (*x)[j * incx] = 1.0 / (j + 1);
+
+                // Сверка с наивным циклом на одном прогоне
+                std::vector<double> y1(*y), y2(*y);
+                dgemv_naive(trans, n, n, alpha, a->data(), a->ld(), x->data(), incx, beta, y1.data(), incy, max_threads);
+                dgemv(gemv_kernels, trans, n, n, alpha, a->data(), a->ld(), x->data(), incx, beta, y2.data(), incy, max_threads);
+                double err = 0;
+                for (long i = 0; i < n; i++)
+                    err = std::max(err, std::abs(y1[i * incy] - y2[i * incy]) / std::max(1e-300, std::abs(y1[i * incy])));
+
+                Case c;
+                c.run = [=, &h, &gemv_kernels](int threads) {
+                    h.metric("rel err", err);
+                    double t = omp_get_wtime();
+                    if (naive)
+                        dgemv_naive(trans, n, n, alpha, a->data(), a->ld(), x->data(), incx, beta, y->data(), incy, threads);
+                    else
+                        dgemv(gemv_kernels, trans, n, n, alpha, a->data(), a->ld(), x->data(), incx, beta, y->data(), incy, threads);
+                    return omp_get_wtime() - t;
+                };
+                c.rates = {{"GB/s", 8.0 * n * n / 1e9}, {"GFLOP/s", 2.0 * n * n / 1e9}};
+                c.tags = {{"isa", isa_name(naive ? Isa::Scalar : gemv_kernels.isa)}};
+                return c;
+            });
+        }
+    }
+
+    // GEMM C = A·B на n×n с упаковкой и микроядром — только с --gemm: O(n³) и три
+    // матрицы n×n на размерах лабы по умолчанию (40000 — 38 ГБ) не проходят,
+    // размеры задаются явно (--gemm --sizes 2000,4000 --kernels gemm).
+    // --peak-ghz — частота для пика, если не определилась сама.
+    // Пик = потоки × ГГц × FLOP/такт выбранного ядра
+    const GemmKernel gemm_kernel = select_gemm_kernel(isa);
+    const double ghz = h.option("peak-ghz", cpu_ghz());
+    if (h.flag("gemm")) {
+        h.add("gemm", [&](long n) {
+            auto a = std::make_shared<Matrix<double>>(n, n);
+            auto b = std::make_shared<Matrix<double>>(n, n);
+            auto c = std::make_shared<Matrix<double>>(n, n);
+            #pragma omp parallel for schedule(static) num_threads(max_threads)
+            for (long i = 0; i < n; i++)
+                for (long j = 0; j < n; j++) {
+                    (*a)(i, j) = ((i + 2 * j) % 7 - 3) * 0.25;
+                    (*b)(i, j) = ((2 * i + j) % 5 - 2) * 0.5;
+                }
+
+            // Сверка первых строк с тройным циклом
+            const int check_rows = 8;
+            Matrix<double> ref(check_rows, n);
+            dgemm(gemm_kernel, n, n, n, 1.0, a->data(), a->ld(), b->data(), b->ld(), 0.0, c->data(), c->ld(), max_threads);
+            dgemm_naive(n, n, n, 1.0, a->data(), a->ld(), b->data(), b->ld(), 0.0, ref.data(), ref.ld(), check_rows, max_threads);
+            double err = 0;
+            for (long i = 0; i < std::min<long>(n, check_rows); i++)
+                for (long j = 0; j < n; j++)
+                    err = std::max(err, std::abs(ref(i, j) - (*c)(i, j)));
+
+            Case cs;
+            cs.run = [=, &h, &gemm_kernel](int threads) {
+                h.metric("max err", err);
+                double t = omp_get_wtime();
+                dgemm(gemm_kernel, n, n, n, 1.0, a->data(), a->ld(), b->data(), b->ld(), 0.0, c->data(), c->ld(), threads);
+                t = omp_get_wtime() - t;
+                if (ghz > 0)
+                    h.metric("% peak", 100.0 * 2.0 * n * n * n / t / (threads * ghz * 1e9 * gemm_flops_per_cycle(gemm_kernel.isa)));
+                return t;
+            };
+            cs.rates = {{"GFLOP/s", 2.0 * n * n * n / 1e9}};
+            cs.tags = {{"isa", isa_name(gemm_kernel.isa)},
+                       {"tile", std::to_string(gemm_kernel.mr) + "x" + std::to_string(gemm_kernel.nr)}};
+            return cs;
+        });
+    }
+
+    // Матрица множителями: построение + масштабирование и умножение на вектор.
+    // До --check-max результат сверяется с плотным путём (fused и dgemv)
+    const long check_max = h.option("check-max", 4000L);
+    for (bool mv : {false, true}) {
+        h.add(mv ? "lowrank-gemv" : "lowrank", [&, mv](long n) {
+            auto a = std::make_shared<LowRankMatrix>(n, 2);
+            auto b = std::make_shared<std::vector<double>>(n);
+            auto x = std::make_shared<std::vector<double>>(n);
+            auto y = std::make_shared<std::vector<double>>(n);
+            for (long j = 0; j < n; j++)
+                (*x)[j] = 1.0 / (j + 1);
+            run_parallel_lowrank(n, max_threads, *a, *b);
+            double diff = -1;
+            if (n <= check_max) {
+                Matrix<double> dense(n, n), lr(n, n);
+                std::vector<double> bd(n), yd(n);
+                run_parallel(n, max_threads, dense, bd, kernels, Mode::Fused);
+                diff = 0;
+                if (mv) {
+                    dgemv(gemv_kernels, Trans::No, n, n, 1.0, dense.data(), dense.ld(), x->data(), 1, 0.0, yd.data(), 1, max_threads);
+                    a->matvec(x->data(), y->data(), max_threads);
+                    for (long i = 0; i < n; i++)
+                        diff = std::max(diff, std::abs(yd[i] - (*y)[i]) / std::max(1.0, std::abs(yd[i])));
+                } else {
+                    a->to_dense(lr, max_threads);
+                    for (long i = 0; i < n; i++)
+                        for (long j = 0; j < n; j++)
+                            diff = std::max(diff, std::abs(dense(i, j) - lr(i, j)));
+                }
+            }
+            Case c;
+            c.run = [=, &h](int threads) {
+                if (diff >= 0)
+                    h.metric("diff vs dense", diff);
+                if (!mv)
+                    return run_parallel_lowrank(n, threads, *a, *b);
+                double t = omp_get_wtime();
+                a->matvec(x->data(), y->data(), threads);
+                return omp_get_wtime() - t;
+            };
+            c.tags = {{"rank", std::to_string(a->rank())}};
+            return c;
+        });
+    }
+
+    // --mmap файл [--window-mb M] — матрица в файле вместо памяти
+    const std::string mmap_path = h.option("mmap", "");
+    const size_t window_bytes = (size_t)h.option("window-mb", 512L) << 20;
+    if (!mmap_path.empty()) {
+        h.add("mmap", [&](long n) {
+            auto a = std::make_shared<MappedMatrix<double>>(mmap_path, n, n);
+            auto b = std::make_shared<std::vector<double>>(n);
+            Case c;
+            c.run = [=, &h, &kernels](int threads) {
+                double io_bytes;
+                double t = run_parallel_mapped(n, threads, *a, *b, kernels, window_bytes, io_bytes);
+                h.metric("disk GB/s", io_bytes / 1e9 / t);
+                return t;
+            };
+            c.tags = {{"isa", isa_name(kernels.isa)}, {"window-mb", std::to_string(window_bytes >> 20)}};
+            return c;
+        });
+    }
+    return h.run();
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <omp.h>
+
+// Адаптивная квадратура Гаусса–Кронрода 7–15: отрезок, на котором оценка
+// погрешности больше его доли допуска, делится пополам, половины уходят
+// задачами OpenMP — свободные потоки забирают их сами, баланс нагрузки
+// не зависит от того, где функция сложная.
+
+struct QuadResult {
+    double value = 0.0;
+    double error = 0.0;  // оценка погрешности (сумма по принятым отрезкам)
+    long intervals = 0;  // принятых отрезков
+    long evals = 0;      // вычислений функции
+};
+
+// Узлы Кронрода на [0, 1] по убыванию (узлы Гаусса — нечётные индексы) и веса (QUADPACK qk15)
+const double GK15_X[8] = {0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+                          0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+                          0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+                          0.207784955007898467600689403773245, 0.0};
+const double GK15_WK[8] = {0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+                           0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+                           0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+                           0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+const double GK15_WG[4] = {0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+                           0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+// Одно правило на [a, b]: значение по Кронроду, погрешность — по формуле QUADPACK
+template <typename F>
+void gauss_kronrod15(F func, double a, double b, double& value, double& error) {
+    const double c = 0.5 * (a + b), r = 0.5 * (b - a);
+    double fv[15];
+    fv[7] = func(c);
+    for (int k = 0; k < 7; k++) {
+        fv[k] = func(c - r * GK15_X[k]);
+        fv[14 - k] = func(c + r * GK15_X[k]);
+    }
+    double kron = GK15_WK[7] * fv[7], gauss = GK15_WG[3] * fv[7], abs_sum = std::abs(kron);
+    for (int k = 0; k < 7; k++) {
+        double pair = fv[k] + fv[14 - k];
+        kron += GK15_WK[k] * pair;
+        abs_sum += GK15_WK[k] * (std::abs(fv[k]) + std::abs(fv[14 - k]));
+        if (k % 2 == 1)
+            gauss += GK15_WG[k / 2] * pair;
+    }
+    // Разброс относительно среднего — масштаб для оценки погрешности
+    const double mean = 0.5 * kron;
+    double asc = GK15_WK[7] * std::abs(fv[7] - mean);
+    for (int k = 0; k < 7; k++)
+        asc += GK15_WK[k] * (std::abs(fv[k] - mean) + std::abs(fv[14 - k] - mean));
+
+    value = kron * r;
+    error = std::abs((kron - gauss) * r);
+    asc *= std::abs(r);
+    if (asc != 0.0 && error != 0.0)
+        error = asc * std::min(1.0, std::pow(200.0 * error / asc, 1.5));
+    const double eps = 2.220446049250313e-16;
+    if (abs_sum * std::abs(r) > 2.2250738585072014e-308 / (50.0 * eps))
+        error = std::max(50.0 * eps * abs_sum * std::abs(r), error);
+}
+
+// Отрезок [a, b] с уже посчитанными value/error: принять или поделить.
+// Допуск на отрезок — доля общего допуска tol, пропорциональная длине.
+// Оценка на уровне ошибок округления (см. 50·eps в gauss_kronrod15) делением
+// не уменьшится — такой отрезок тоже принимается, иначе недостижимый допуск
+// развалил бы отрезок до max_depth.
+template <typename F>
+void adaptive_step(F& func, double a, double b, double value, double error, double tol_density, int depth,
+                   int max_depth, QuadResult& res) {
+    const double roundoff = 100.0 * 2.220446049250313e-16 * std::abs(value);
+    if (error <= tol_density * (b - a) || error <= roundoff || depth >= max_depth) {
+        #pragma omp atomic
+        res.value += value;
+        #pragma omp atomic
+        res.error += error;
+        #pragma omp atomic
+        res.intervals += 1;
+        return;
+    }
+    const double m = 0.5 * (a + b);
+    // параметры по значению — копиями: кадр этого вызова может уйти раньше задачи
+    #pragma omp task default(none) shared(func, res) firstprivate(a, m, tol_density, depth, max_depth)
+    {
+        double v, e;
+        gauss_kronrod15(func, a, m, v, e);
+        #pragma omp atomic
+        res.evals += 15;
+        adaptive_step(func, a, m, v, e, tol_density, depth + 1, max_depth, res);
+    }
+    double v, e;
+    gauss_kronrod15(func, m, b, v, e);
+    #pragma omp atomic
+    res.evals += 15;
+    adaptive_step(func, m, b, v, e, tol_density, depth + 1, max_depth, res);
+}
+
+// ∫ func на [a, b] с точностью max(abs_tol, rel_tol·|I|). |I| оценивается
+// по правилу на всём отрезке, поэтому допуск фиксируется до деления.
+template <typename F>
+QuadResult integrate_adaptive(F func, double a, double b, double abs_tol, double rel_tol, int thread_numb,
+                              int max_depth = 40) {
+    QuadResult res;
+    double value, error;
+    gauss_kronrod15(func, a, b, value, error);
+    res.evals = 15;
+    const double tol = std::max(abs_tol, rel_tol * std::abs(value));
+    const double tol_density = tol / (b - a);
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        #pragma omp single
+        adaptive_step(func, a, b, value, error, tol_density, 0, max_depth, res);
+    }
+    return res;
+}
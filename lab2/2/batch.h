@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+// Пакет интегралов одним параллельным регионом. Для мелких n вызов
+// integrate_omp на каждый интеграл — это fork/join на каждый; здесь все
+// задания режутся на куски по BATCH_CHUNK точек, куски всех заданий идут
+// одним общим циклом (потоки делят и задания, и точки внутри крупных),
+// суммы кусков собираются по заданиям в том же регионе.
+
+struct IntegralJob {
+    double (*func)(double);
+    double a, b;
+    int n;
+    double result = 0.0;
+};
+
+const int BATCH_CHUNK = 2048;
+
+inline void integrate_batch(std::vector<IntegralJob>& jobs, int thread_numb) {
+    const long njobs = (long)jobs.size();
+    // first[j] — номер первого куска задания j, first[njobs] — всего кусков
+    std::vector<long> first(njobs + 1, 0);
+    for (long j = 0; j < njobs; j++)
+        first[j + 1] = first[j] + std::max(1, (jobs[j].n + BATCH_CHUNK - 1) / BATCH_CHUNK);
+    const long chunks = first[njobs];
+    std::vector<double> partial(chunks);
+
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        // Задание куска: куски одного потока обычно идут подряд в одном
+        // задании, поэтому бинарный поиск — только при выходе за его границы
+        long job = -1;
+        #pragma omp for schedule(dynamic, 4)
+        for (long c = 0; c < chunks; c++) {
+            if (job < 0 || c < first[job] || c >= first[job + 1])
+                job = std::upper_bound(first.begin(), first.end(), c) - first.begin() - 1;
+            const IntegralJob& jb = jobs[job];
+            const double h = (jb.b - jb.a) / jb.n;
+            const int i0 = (int)(c - first[job]) * BATCH_CHUNK, i1 = std::min(jb.n, i0 + BATCH_CHUNK);
+            double s = 0.0;
+            for (int i = i0; i < i1; i++)
+                s += jb.func(jb.a + h * (i + 0.5));
+            partial[c] = s;
+        }
+        #pragma omp for schedule(static)
+        for (long j = 0; j < njobs; j++) {
+            double s = 0.0;
+            for (long c = first[j]; c < first[j + 1]; c++)
+                s += partial[c];
+            jobs[j].result = s * (jobs[j].b - jobs[j].a) / jobs[j].n;
+        }
+    }
+}
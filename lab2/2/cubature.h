@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <omp.h>
+#include "reduce.h"
+
+// Кубатура Монте-Карло / квази-Монте-Карло на единичном кубе [0, 1]^dim.
+// Точки идут блоками по CUBATURE_BLOCK, у блока фиксированный номер, и его
+// точки зависят только от номера — поэтому результат не зависит от числа
+// потоков. Подынтегральная функция считает целый блок за вызов:
+//   func(pts, count, out): координата d точки k — pts[d * CUBATURE_BLOCK + k],
+//   out[k] — значение; внутри удобно писать циклы omp simd по k.
+// Счёт идёт раундами (первый — 64 блока, дальше каждый раунд удваивает
+// объём), после раунда пересчитывается стандартная ошибка, и при
+// std_error <= target_err счёт останавливается.
+
+enum class Sampler { Random, Sobol };
+
+inline const char* sampler_name(Sampler s) { return s == Sampler::Sobol ? "qmc" : "mc"; }
+
+const int CUBATURE_BLOCK = 256;
+const int CUBATURE_MAX_DIM = 10;
+// Для QMC ошибка оценивается по разбросу независимых цифровых сдвигов
+const int QMC_REPLICAS = 8;
+
+struct CubatureResult {
+    double value = 0.0;
+    double std_error = 0.0;
+    long points = 0;
+    int rounds = 0;
+};
+
+// Счётчиковый генератор: случайное число — хеш номера (SplitMix64),
+// потокам не нужно ни состояние, ни раздача подпоследовательностей
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Равномерное на (0, 1) из старших 53 бит
+inline double uniform01(uint64_t x) { return ((x >> 11) + 0.5) * 0x1p-53; }
+
+// Примитивные многочлены и начальные m_i для измерений 2..10 (Joe–Kuo, new-joe-kuo-6.21201)
+struct SobolPoly {
+    int s, a;
+    uint32_t m[5];
+};
+const SobolPoly SOBOL_JOE_KUO[CUBATURE_MAX_DIM - 1] = {
+    {1, 0, {1}},          {2, 1, {1, 3}},       {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},    {4, 1, {1, 1, 3, 3}}, {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}}, {5, 4, {1, 1, 5, 5, 5}}, {5, 7, {1, 1, 7, 11, 19}},
+};
+
+// Направляющие числа v[d][i] (32 бита); измерение 0 — ван дер Корпут
+inline void sobol_directions(uint32_t v[CUBATURE_MAX_DIM][32]) {
+    for (int i = 0; i < 32; i++)
+        v[0][i] = 1u << (31 - i);
+    for (int d = 1; d < CUBATURE_MAX_DIM; d++) {
+        const SobolPoly& p = SOBOL_JOE_KUO[d - 1];
+        for (int i = 0; i < 32; i++) {
+            if (i < p.s) {
+                v[d][i] = p.m[i] << (31 - i);
+                continue;
+            }
+            v[d][i] = v[d][i - p.s] ^ (v[d][i - p.s] >> p.s);
+            for (int k = 1; k < p.s; k++)
+                if ((p.a >> (p.s - 1 - k)) & 1)
+                    v[d][i] ^= v[d][i - k];
+        }
+    }
+}
+
+template <typename F>
+CubatureResult integrate_cubature(F func, int dim, Sampler sampler, double target_err, long max_points, int thread_numb,
+                                  uint64_t seed = 1) {
+    const int reps = sampler == Sampler::Sobol ? QMC_REPLICAS : 1;
+    uint32_t v[CUBATURE_MAX_DIM][32], shift[QMC_REPLICAS][CUBATURE_MAX_DIM];
+    sobol_directions(v);
+    for (int r = 0; r < QMC_REPLICAS; r++)
+        for (int d = 0; d < CUBATURE_MAX_DIM; d++)
+            shift[r][d] = (uint32_t)(splitmix64(~seed + (uint64_t)(r * CUBATURE_MAX_DIM + d)) >> 32);
+    // Номера точек Соболя — 32-битные
+    long max_blocks = std::max(1L, max_points / ((long)CUBATURE_BLOCK * reps));
+    if (sampler == Sampler::Sobol)
+        max_blocks = std::min(max_blocks, (1L << 32) / CUBATURE_BLOCK);
+
+    CubatureResult res;
+    std::vector<double> sum(reps, 0.0), part;
+    double sum2 = 0.0;
+    long done = 0, round = std::min(64L, max_blocks);
+    bool stop = false;
+
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        double pts[CUBATURE_MAX_DIM * CUBATURE_BLOCK], val[CUBATURE_BLOCK];
+        uint32_t X[CUBATURE_MAX_DIM * CUBATURE_BLOCK];
+        while (!stop) {
+            // part[r * round + k] — сумма f по блоку k для сдвига r; для MC
+            // ещё part[round + k] — сумма f²
+            #pragma omp single
+            part.assign((size_t)round * (reps + 1), 0.0);
+            #pragma omp for schedule(static)
+            for (long k = 0; k < round; k++) {
+                const uint64_t i0 = (uint64_t)(done + k) * CUBATURE_BLOCK;
+                if (sampler == Sampler::Random) {
+                    for (int d = 0; d < dim; d++) {
+                        #pragma omp simd
+                        for (int j = 0; j < CUBATURE_BLOCK; j++)
+                            pts[d * CUBATURE_BLOCK + j] =
+                                uniform01(splitmix64(seed + (i0 + j) * CUBATURE_MAX_DIM + d));
+                    }
+                    func(pts, CUBATURE_BLOCK, val);
+                    double s = 0.0, s2 = 0.0;
+                    #pragma omp simd reduction(+:s, s2)
+                    for (int j = 0; j < CUBATURE_BLOCK; j++) {
+                        s += val[j];
+                        s2 += val[j] * val[j];
+                    }
+                    part[k] = s;
+                    part[round + k] = s2;
+                    continue;
+                }
+                // Соболь в порядке кода Грея: первая точка блока — по битам
+                // номера, следующие — одним xor с v[ctz(i + 1)]
+                const uint64_t g = i0 ^ (i0 >> 1);
+                for (int d = 0; d < dim; d++) {
+                    uint32_t x = 0;
+                    for (int bit = 0; bit < 32; bit++)
+                        if ((g >> bit) & 1)
+                            x ^= v[d][bit];
+                    for (int j = 0; j < CUBATURE_BLOCK; j++) {
+                        X[d * CUBATURE_BLOCK + j] = x;
+                        x ^= v[d][__builtin_ctzll(i0 + j + 1) & 31];
+                    }
+                }
+                for (int r = 0; r < reps; r++) {
+                    for (int d = 0; d < dim; d++) {
+                        const uint32_t sh = shift[r][d];
+                        #pragma omp simd
+                        for (int j = 0; j < CUBATURE_BLOCK; j++)
+                            pts[d * CUBATURE_BLOCK + j] = ((X[d * CUBATURE_BLOCK + j] ^ sh) + 0.5) * 0x1p-32;
+                    }
+                    func(pts, CUBATURE_BLOCK, val);
+                    double s = 0.0;
+                    #pragma omp simd reduction(+:s)
+                    for (int j = 0; j < CUBATURE_BLOCK; j++)
+                        s += val[j];
+                    part[r * round + k] = s;
+                }
+            }
+            // Суммы блоков — фиксированным деревом, в раундах по порядку
+            #pragma omp single
+            {
+                for (int r = 0; r < reps; r++)
+                    sum[r] += tree_sum(part.data() + r * round, round);
+                if (sampler == Sampler::Random)
+                    sum2 += tree_sum(part.data() + round, round);
+                done += round;
+                res.rounds++;
+                const double N = (double)done * CUBATURE_BLOCK;
+                if (sampler == Sampler::Random) {
+                    res.value = sum[0] / N;
+                    const double var = std::max(0.0, sum2 / N - res.value * res.value) * N / (N - 1);
+                    res.std_error = std::sqrt(var / N);
+                } else {
+                    res.value = 0.0;
+                    for (int r = 0; r < reps; r++)
+                        res.value += sum[r] / N;
+                    res.value /= reps;
+                    double dev = 0.0;
+                    for (int r = 0; r < reps; r++)
+                        dev += (sum[r] / N - res.value) * (sum[r] / N - res.value);
+                    res.std_error = std::sqrt(dev / (reps * (reps - 1)));
+                }
+                stop = res.std_error <= target_err || done >= max_blocks;
+                round = std::min(done, max_blocks - done);
+            }
+        }
+    }
+    res.points = done * CUBATURE_BLOCK * reps;
+    return res;
+}
@@ -2,6 +2,21 @@
 #include <omp.h>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <memory>
+#include <climits>
+#include <stdexcept>
+#include "harness.h"
+#include "vmath.h"
+#include "quadrature.h"
+#include "adaptive.h"
+#include "reduce.h"
+#include "batch.h"
+#include "cubature.h"
+#include "perf_counters.h"
+#include "affinity.h"
 
 const double a = -4.0; 
 const double b = 4.0; 
@@ -27,21 +42,284 @@ double integrate_omp(double (*func)(double), double a, double b, int n, int thre
     return sum;
 }
 
-double run_parallel (double a, double b, int nsteps, int thread_numb) {
-    double t = omp_get_wtime();
-    double res = integrate_omp(func, a, b, nsteps, thread_numb);
-    t = omp_get_wtime() - t;
-    return t;
+// То же для любого вызываемого объекта: подынтегральная функция встраивается,
+// цикл идёт как SIMD-редукция. Указатель на функцию по-прежнему попадает
+// в нешаблонную версию выше (точное совпадение предпочтительнее шаблона).
+template <typename F>
+double integrate_omp(F func, double a, double b, int n, int thread_numb) {
+    double h = (b - a) / n;
+    double sum = 0.0;
+    #pragma omp parallel for simd reduction(+:sum) num_threads(thread_numb)
+    for (int i = 0; i < n; i++)
+        sum += func(a + h * (i + 0.5));
+    sum *= h;
+    return sum;
+}
+
+// exp(-x²) для встраивания в SIMD-цикл: exp_core из vmath.h — без ветвлений
+// и вызовов, векторизуется вместе с циклом (вызов std::exp без -ffast-math
+// остаётся скалярным вызовом libm). Аргумент -x² ∈ [-16, 0] на [a, b] — в
+// рабочем диапазоне ядра (|x| ≤ 708), проход исправления не нужен.
+// vmath с -ffast-math не собирается — там std::exp уходит в libmvec.
+inline double gauss_exp(double x) {
+#ifdef __FAST_MATH__
+    return std::exp(-x * x);
+#else
+    return exp_core(-x * x);
+#endif
 }
 
-int main() {
-    int threads[8] = {1,2,4,7,8,16,20,40};
-    double T1 = run_parallel(a, b, nsteps, 1);
-    std::cout << "T1 = " << T1 << std::endl;
-    for(int i = 1; i < 8; i++) {
-            double TN = run_parallel(a, b, nsteps,  threads[i]);
-            double S = T1/TN;
-            std::cout << "T" << threads[i] << " = " << TN << " S" << threads[i] << " = " << S << std::endl;
+// Выбор правила; n — число вычислений функции
+template <typename F>
+double integrate_omp(F func, double a, double b, int n, int thread_numb, Rule rule) {
+    switch (rule) {
+    case Rule::Simpson: return integrate_simpson(func, a, b, n, thread_numb);
+    case Rule::Gauss: return integrate_gauss(func, a, b, n, thread_numb);
+    case Rule::TanhSinh: return integrate_tanh_sinh(func, a, b, n, thread_numb);
+    default: return integrate_omp(func, a, b, n, thread_numb);
+    }
+}
+
+// exp(-x²) блоками через vexp: поток заполняет аргументы блока и считает
+// экспоненты одним вызовом векторной библиотеки
+double integrate_vmath(double a, double b, int n, int thread_numb) {
+    const int block = 512;
+    double h = (b - a) / n;
+    double sum = 0.0;
+    #pragma omp parallel num_threads(thread_numb)
+    {
+        double arg[block], val[block];
+        double sumloc = 0.0;
+        #pragma omp for schedule(static)
+        for (int i0 = 0; i0 < n; i0 += block) {
+            const int len = std::min(block, n - i0);
+            for (int j = 0; j < len; j++) {
+                double x = a + h * (i0 + j + 0.5);
+                arg[j] = -x * x;
+            }
+            vexp(arg, val, len);
+            for (int j = 0; j < len; j++)
+                sumloc += val[j];
         }
-    return 0; 
-}
\ No newline at end of file
+        #pragma omp atomic
+        sum += sumloc;
+    }
+    return sum * h;
+}
+
+// Воспроизводимый вариант integrate_omp: суммы блоков по индексу и фиксированное
+// дерево (reduce.h) вместо atomic в порядке завершения потоков — результат
+// побитово не зависит от числа потоков
+template <typename F>
+double integrate_reproducible(F func, double a, double b, int n, int thread_numb) {
+    const double h = (b - a) / n;
+    return reproducible_sum(n, [&](long i) { return func(a + h * (i + 0.5)); }, thread_numb) * h;
+}
+
+// Точное значение double для сравнения прогонов побитово
+std::string hex_bits(double x) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%a", x);
+    return buf;
+}
+
+int main(int argc, char** argv) {
+    Harness h(argc, argv, {nsteps}, {1, 2, 4, 7, 8, 16, 20, 40});
+    // --perf: счётчики каждого потока OpenMP вокруг каждого замера
+    PerfProbe perf;
+    if (h.flag("perf"))
+        h.probe(&perf);
+    // --affinity: перебор политик привязки потоков
+    add_affinity_sweep(h);
+    // размер — число точек nsteps; integrate — через указатель на функцию,
+    // inline — шаблонная версия с встроенной exp(-x²) (gauss_exp), vmath — блоками через vexp
+    const char* names[] = {"integrate", "inline", "vmath"};
+    for (int variant = 0; variant < 3; variant++) {
+#ifdef __FAST_MATH__
+        if (variant == 2)
+            continue;  // vmath требует строгой арифметики
+#endif
+        h.add(names[variant], [&, variant](long n) {
+            Case c;
+            c.run = [&h, n, variant](int threads) {
+                double res;
+                double t = omp_get_wtime();
+                if (variant == 0)
+                    res = integrate_omp(func, a, b, (int)n, threads);
+                else if (variant == 1)
+                    res = integrate_omp([](double x) { return gauss_exp(x); }, a, b, (int)n, threads);
+                else
+                    res = integrate_vmath(a, b, (int)n, threads);
+                t = omp_get_wtime() - t;
+                h.metric("value", res);
+                h.metric("ns/point", t / n * 1e9);
+                return t;
+            };
+            c.rates = {{"Gpoint/s", n / 1e9}};
+            return c;
+        });
+    }
+
+    // Воспроизводимая редукция: value в bits совпадает для любого --threads;
+    // overhead — относительно integrate с atomic на том же числе потоков
+    h.add("reproducible", [&](long n) {
+        Case c;
+        c.run = [&h, n](int threads) {
+            double t0 = omp_get_wtime();
+            integrate_omp(func, a, b, (int)n, threads);
+            t0 = omp_get_wtime() - t0;
+            double t = omp_get_wtime();
+            double res = integrate_reproducible(func, a, b, (int)n, threads);
+            t = omp_get_wtime() - t;
+            h.metric("value", res);
+            h.metric("overhead", t / t0 - 1.0);
+            h.tag("bits", hex_bits(res));
+            return t;
+        };
+        c.rates = {{"Gpoint/s", n / 1e9}};
+        return c;
+    });
+
+    // Пакет интегралов одним регионом: --batch 1,16,256,4096 заданий по
+    // --batch-points (10000) точек, пределы разные; общий размер nsteps для
+    // пакета не используется. loop speedup — против цикла из вызовов
+    // integrate_omp, каждый со своим регионом
+    const long batch_points = h.option("batch-points", 10000L);
+    if (batch_points <= 0 || batch_points > INT_MAX)
+        throw std::runtime_error("--batch-points must be in [1, " + std::to_string(INT_MAX) + "]");
+    for (const std::string& count : h.list("batch", "1,16,256,4096")) {
+        const long jobs_count = std::stol(count);
+        h.add("batch/" + count, [&h, jobs_count, batch_points](long) {
+            const long n = batch_points;
+            auto jobs = std::make_shared<std::vector<IntegralJob>>(jobs_count);
+            for (long j = 0; j < jobs_count; j++) {
+                IntegralJob& jb = (*jobs)[j];
+                jb.func = func;
+                jb.a = -1.0 - j % 4;
+                jb.b = 1.0 + j % 7;
+                jb.n = (int)n;
+            }
+            Case c;
+            c.run = [&h, jobs](int threads) {
+                double t0 = omp_get_wtime();
+                double diff = 0.0;
+                for (const IntegralJob& jb : *jobs)
+                    diff = std::max(diff, std::abs(integrate_omp(jb.func, jb.a, jb.b, jb.n, threads) - jb.result));
+                t0 = omp_get_wtime() - t0;
+                double t = omp_get_wtime();
+                integrate_batch(*jobs, threads);
+                t = omp_get_wtime() - t;
+                h.metric("loop speedup", t0 / t);
+                h.metric("diff vs loop", diff);
+                return t;
+            };
+            c.rates = {{"Mjob/s", jobs_count / 1e6}, {"Gpoint/s", jobs_count * (double)n / 1e9}};
+            c.tags = {{"points", std::to_string(n)}};
+            return c;
+        });
+    }
+
+    // Многомерные интегралы: ∫ exp(-|x|²) по [0, 1]^dim = (√π/2·erf(1))^dim.
+    // mc/<dim> — случайные точки, qmc/<dim> — Соболь со сдвигами; --dims 4,6,10,
+    // --target-err (1e-4) — останов по стандартной ошибке, размер — предел числа точек
+    const double target_err = h.option("target-err", 1e-4);
+    for (Sampler sampler : {Sampler::Random, Sampler::Sobol}) {
+        for (const std::string& dims : h.list("dims", "4,6,10")) {
+            const int dim = std::min(std::stoi(dims), CUBATURE_MAX_DIM);
+            h.add(std::string(sampler_name(sampler)) + "/" + dims, [&h, sampler, dim, target_err](long n) {
+                Case c;
+                c.run = [&h, n, sampler, dim, target_err](int threads) {
+                    auto gaussian = [dim](const double* pts, int count, double* out) {
+                        double arg[CUBATURE_BLOCK];
+                        #pragma omp simd
+                        for (int k = 0; k < count; k++)
+                            arg[k] = 0.0;
+                        for (int d = 0; d < dim; d++) {
+                            const double* x = pts + d * CUBATURE_BLOCK;
+                            #pragma omp simd
+                            for (int k = 0; k < count; k++)
+                                arg[k] -= x[k] * x[k];
+                        }
+#ifdef __FAST_MATH__
+                        #pragma omp simd
+                        for (int k = 0; k < count; k++)
+                            out[k] = std::exp(arg[k]);
+#else
+                        vexp(arg, out, count);
+#endif
+                    };
+                    double t = omp_get_wtime();
+                    CubatureResult q = integrate_cubature(gaussian, dim, sampler, target_err, n, threads);
+                    t = omp_get_wtime() - t;
+                    h.metric("value", q.value);
+                    h.metric("std error", q.std_error);
+                    h.metric("error", std::abs(q.value - std::pow(0.5 * std::sqrt(M_PI) * std::erf(1.0), dim)));
+                    h.metric("points", (double)q.points);
+                    h.metric("Mpoint/s", q.points / t / 1e6);
+                    return t;
+                };
+                return c;
+            });
+        }
+    }
+
+    // Правила высокого порядка при том же бюджете вычислений (размер = n вычислений)
+    // и время до точности: для --accuracy (1e-12) подбирается наименьшее n = 2^k,
+    // при котором |I - √π·erf(4)| не больше заданного, и замеряется прогон с ним
+    // (в tta/* размер не используется)
+    const double exact = std::sqrt(M_PI) * std::erf(4.0);
+    const double accuracy = h.option("accuracy", 1e-12);
+    auto integrand = [](double x) { return std::exp(-x * x); };
+    for (Rule rule : {Rule::Midpoint, Rule::Simpson, Rule::Gauss, Rule::TanhSinh}) {
+        if (rule != Rule::Midpoint) {
+            h.add(rule_name(rule), [&, rule](long n) {
+                Case c;
+                c.run = [&, n, rule](int threads) {
+                    double t = omp_get_wtime();
+                    double res = integrate_omp(integrand, a, b, (int)n, threads, rule);
+                    t = omp_get_wtime() - t;
+                    h.metric("value", res);
+                    h.metric("error", std::abs(res - exact));
+                    return t;
+                };
+                c.rates = {{"Gpoint/s", n / 1e9}};
+                return c;
+            });
+        }
+        h.add(std::string("tta/") + rule_name(rule), [&, rule](long) {
+            long n = 16;
+            while (n < (1L << 30) && std::abs(integrate_omp(integrand, a, b, (int)n, omp_get_max_threads(), rule) - exact) > accuracy)
+                n *= 2;
+            Case c;
+            c.run = [&, n, rule](int threads) {
+                double t = omp_get_wtime();
+                double res = integrate_omp(integrand, a, b, (int)n, threads, rule);
+                t = omp_get_wtime() - t;
+                h.metric("evals", (double)n);
+                h.metric("error", std::abs(res - exact));
+                h.metric("accuracy", accuracy);
+                return t;
+            };
+            return c;
+        });
+    }
+
+    // Адаптивная Гаусса–Кронрода на задачах OpenMP; --abs-tol, --rel-tol (размер не используется)
+    const double abs_tol = h.option("abs-tol", 1e-12), rel_tol = h.option("rel-tol", 0.0);
+    h.add("adaptive", [&](long) {
+        Case c;
+        c.run = [&](int threads) {
+            double t = omp_get_wtime();
+            QuadResult q = integrate_adaptive(integrand, a, b, abs_tol, rel_tol, threads);
+            t = omp_get_wtime() - t;
+            h.metric("value", q.value);
+            h.metric("error estimate", q.error);
+            h.metric("error", std::abs(q.value - exact));
+            h.metric("intervals", (double)q.intervals);
+            h.metric("evals", (double)q.evals);
+            return t;
+        };
+        return c;
+    });
+    return h.run();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+// Квадратурные правила высокого порядка. Везде n — число вычислений
+// подынтегральной функции (бюджет), чтобы правила сравнивались честно;
+// параллельно делятся подотрезки (узлы для tanh-sinh).
+
+enum class Rule { Midpoint, Simpson, Gauss, TanhSinh };
+
+inline const char* rule_name(Rule r) {
+    switch (r) {
+    case Rule::Simpson: return "simpson";
+    case Rule::Gauss: return "gauss";
+    case Rule::TanhSinh: return "tanh-sinh";
+    default: return "midpoint";
+    }
+}
+
+// Составная формула Симпсона: m = (n - 1) / 2 подотрезков, концы соседних
+// подотрезков общие — 2m + 1 вычислений
+template <typename F>
+double integrate_simpson(F func, double a, double b, int n, int thread_numb) {
+    const int m = std::max(1, (n - 1) / 2);
+    const double h = (b - a) / m;
+    double sum = 0.0;
+    #pragma omp parallel for reduction(+:sum) num_threads(thread_numb)
+    for (int i = 0; i < m; i++) {
+        double x = a + h * i;
+        sum += 4.0 * func(x + 0.5 * h) + (i > 0 ? 2.0 * func(x) : 0.0);
+    }
+    return (sum + func(a) + func(b)) * h / 6.0;
+}
+
+// 8-точечная формула Гаусса–Лежандра на [-1, 1] (порядок 16): узлы ±x[k], веса w[k]
+const double GAUSS8_X[4] = {0.1834346424956498049, 0.5255324099163289858, 0.7966664774136267396, 0.9602898564975362317};
+const double GAUSS8_W[4] = {0.3626837833783619830, 0.3137066458778872873, 0.2223810344533744706, 0.1012285362903762592};
+
+// Составная Гаусса–Лежандра: n / 8 подотрезков по 8 узлов
+template <typename F>
+double integrate_gauss(F func, double a, double b, int n, int thread_numb) {
+    const int m = std::max(1, n / 8);
+    const double h = (b - a) / m;
+    double sum = 0.0;
+    #pragma omp parallel for reduction(+:sum) num_threads(thread_numb)
+    for (int i = 0; i < m; i++) {
+        const double c = a + h * (i + 0.5), r = 0.5 * h;
+        double s = 0.0;
+        for (int k = 0; k < 4; k++)
+            s += GAUSS8_W[k] * (func(c - r * GAUSS8_X[k]) + func(c + r * GAUSS8_X[k]));
+        sum += s;
+    }
+    return sum * 0.5 * h;
+}
+
+// tanh-sinh (двойная экспонента): x = tanh(π/2·sinh t), t ∈ [-T, T] с шагом
+// 2T / (n - 1). Вес w(t) = π/2·cosh t / cosh²(π/2·sinh t) на краю:
+// T = 3 — w ≈ 1.4e-12, 1 − x ≈ 4e-14 (хвост заметно выше точности double),
+// T = 3.5 — w ≈ 3e-21, 1 − x ≈ 5e-23: отброшенный хвост ниже eps.
+// Начиная с t ≈ 3.17 узел x округляется к ±1 (w там < 5e-15); такие узлы
+// пропускаются, чтобы не считать f в самих концах. Для f с особенностью в
+// конце это и есть предел точности: f вычисляется по x, а не по расстоянию
+// 1 − x, поэтому ближе ~1e-16 к концу узлов нет (для 1/√(1 − x) — ~1e-8)
+template <typename F>
+double integrate_tanh_sinh(F func, double a, double b, int n, int thread_numb) {
+    const double T = 3.5, half_pi = 1.5707963267948966;
+    const int m = std::max(3, n) / 2;                 // узлы -m..m
+    const double step = T / m;
+    const double c = 0.5 * (a + b), r = 0.5 * (b - a);
+    double sum = 0.0;
+    #pragma omp parallel for reduction(+:sum) num_threads(thread_numb)
+    for (int k = -m; k <= m; k++) {
+        // sinh, cosh, tanh через две экспоненты вместо четырёх вызовов
+        double et = std::exp(k * step), iet = 1.0 / et;
+        double u = half_pi * 0.5 * (et - iet);
+        double eu = std::exp(u), ieu = 1.0 / eu;
+        double ch = 0.5 * (eu + ieu);
+        double x = (eu - ieu) / (eu + ieu);
+        double w = half_pi * 0.5 * (et + iet) / (ch * ch);
+        if (std::abs(x) < 1.0)
+            sum += w * func(c + r * x);
+    }
+    return sum * r * step;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <omp.h>
+#include "operator.h"
+
+// Метод сопряжённых градиентов для симметричной положительно определённой A,
+// с предобусловливателем Якоби (M = diag A) или без него. Весь решатель —
+// один параллельный регион; за итерацию четыре барьера: apply, p·q,
+// общий цикл обновления x, r, z с обеими суммами (r·z и r·r), новое p.
+// Скаляры alpha, beta, rz каждый поток ведёт сам — они одинаковы у всех,
+// потому что считаются из одних и тех же общих сумм.
+// Останов по ‖r‖₂ ≤ tol·‖b‖₂; iterations — число сделанных итераций,
+// residual — итоговая относительная невязка.
+inline std::vector<double> cg_method(const LinearOperator &A, const std::vector<double> &b, int n, int max_iter, double tol,
+                                     bool precondition, int &iterations, double &residual) {
+    std::vector<double> x(n, 0.0), r(b), z(n), p(n), q(n), dinv(n, 1.0);
+    if (precondition)
+        for (int i = 0; i < n; i++)
+            dinv[i] = 1.0 / A.diagonal(i);
+    double bb = 0.0, rz0 = 0.0, pq = 0.0, rz_new = 0.0, rr = 0.0;
+    int iters = 0;
+    #pragma omp parallel
+    {
+        // x = 0: r = b, z = M⁻¹r, p = z
+        #pragma omp for reduction(+:bb, rz0)
+        for (int i = 0; i < n; i++) {
+            z[i] = dinv[i] * r[i];
+            p[i] = z[i];
+            bb += r[i] * r[i];
+            rz0 += r[i] * z[i];
+        }
+        double rz = rz0;
+        const double stop = tol * tol * bb;
+        int iter = 0;
+        while (iter < max_iter && bb > 0.0) {
+            A.apply(p.data(), q.data());
+            // rz_new и rr прочитаны всеми до барьера прошлого обновления p
+            #pragma omp single nowait
+            rz_new = rr = 0.0;
+            #pragma omp for reduction(+:pq)
+            for (int i = 0; i < n; i++)
+                pq += p[i] * q[i];
+            const double alpha = rz / pq;
+            #pragma omp for reduction(+:rz_new, rr)
+            for (int i = 0; i < n; i++) {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+                z[i] = dinv[i] * r[i];
+                rz_new += r[i] * z[i];
+                rr += r[i] * r[i];
+            }
+            iter++;
+            if (rr <= stop)
+                break;
+            const double beta = rz_new / rz;
+            rz = rz_new;
+            // pq все прочитали до барьера обновления x
+            #pragma omp single nowait
+            pq = 0.0;
+            #pragma omp for
+            for (int i = 0; i < n; i++)
+                p[i] = z[i] + beta * p[i];
+        }
+        #pragma omp master
+        iters = iter;
+    }
+    iterations = iters;
+    residual = bb > 0.0 ? std::sqrt(rr / bb) : 0.0;
+    return x;
+}
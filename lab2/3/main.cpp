@@ -2,9 +2,25 @@
 #include <omp.h>
 #include <vector>
 #include <cmath>
+#include <string>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include "matrix.h"
+#include "mapped_matrix.h"
+#include "lowrank.h"
+#include "reduce.h"
+#include "operator.h"
+#include "cg.h"
+#include "relaxation.h"
+#include "harness.h"
+#include "perf_counters.h"
+#include "affinity.h"
 
-void initialize_matrix(std::vector<std::vector<double>> &A, std::vector<double> &b, int n) {
-    // Заполнение матрицы A и вектора b
+void initialize_matrix(Matrix<double> &A, std::vector<double> &b, int n) {
+    // Заполнение матрицы A и вектора b.
+    // Параллельно и static, как в решателях: заодно это first touch страниц A
+    #pragma omp parallel for schedule(static)
     for (int i = 0; i < n; i++) {
         b[i] = i + 1;
         for (int j = 0; j < n; j++) {
@@ -16,22 +32,37 @@ void initialize_matrix(std::vector<std::vector<double>> &A, std::vector<double>
     }
 }
 
-std::vector<double> jacobi_method_parallel1(const std::vector<std::vector<double>> &A, const std::vector<double> &b, int n, int max_iter, double tol) {
+// Та же матрица в файле (MappedMatrix): заполняется по тайлам
+double initialize_matrix_mapped(MappedMatrix<double> &A, std::vector<double> &b, int n, size_t window_bytes) {
+    for (int i = 0; i < n; i++)
+        b[i] = i + 1;
+    return for_each_tile(A, tile_rows_for(A, window_bytes), true, [&](size_t r0, size_t r1) {
+        #pragma omp parallel for schedule(static)
+        for (long i = (long)r0; i < (long)r1; i++) {
+            double* row = A.row(i);
+            for (int j = 0; j < n; j++)
+                row[j] = (i == j) ? 2.0 : 1.0;
+        }
+    });
+}
+
+std::vector<double> jacobi_method_parallel1(const Matrix<double> &A, const std::vector<double> &b, int n, int max_iter, double tol) {
     std::vector<double> x(n, 0.0), x_old(n, 0.0);
     for (int iter = 0; iter < max_iter; iter++) {
         #pragma omp parallel for
         for (int i = 0; i < n; i++) {
+            const double* row = A.row(i);
             double sigma = 0.0;
             for (int j = 0; j < n; j++) {
                 if (j != i)
-                    sigma += A[i][j] * x_old[j];
+                    sigma += row[j] * x_old[j];
             }
             x[i] = (b[i] - sigma) / A[i][i];
         }
         double error = 0.0;
         #pragma omp parallel for reduction(+:error)
         for (int i = 0; i < n; i++) {
-            error += abs(x[i] - x_old[i]);
+            error += std::abs(x[i] - x_old[i]);
         }
         if (error < tol)
             break;
@@ -40,25 +71,59 @@ std::vector<double> jacobi_method_parallel1(const std::vector<std::vector<double
     return x;
 }
 
-std::vector<double> jacobi_method_parallel2(const std::vector<std::vector<double>> &A, const std::vector<double> &b, int n, int max_iter, double tol) {
+std::vector<double> jacobi_method_parallel2(const Matrix<double> &A, const std::vector<double> &b, int n, int max_iter, double tol) {
     std::vector<double> x(n, 0.0), x_old(n, 0.0);
+    // error общая для команды: редукция в приватную переменную региона не собирается
+    double error = 0.0;
     #pragma omp parallel
     {
         for (int iter = 0; iter < max_iter; iter++) {
+            // сброс до барьера после цикла ниже; прошлое значение все уже прочитали до барьера single
+            #pragma omp single nowait
+            error = 0.0;
             #pragma omp for
             for (int i = 0; i < n; i++) {
+                const double* row = A.row(i);
                 double sigma = 0.0;
                 for (int j = 0; j < n; j++) {
                     if (j != i)
-                        sigma += A[i][j] * x_old[j];
+                        sigma += row[j] * x_old[j];
                 }
                 x[i] = (b[i] - sigma) / A[i][i];
             }
-            double error = 0.0;
             #pragma omp for reduction(+:error)
             for (int i = 0; i < n; i++) {
-                error += abs(x[i] - x_old[i]);
+                error += std::abs(x[i] - x_old[i]);
+            }
+            if (error < tol)
+                break;
+            #pragma omp single
+            x_old = x;
+        }
+    }
+    return x;
+}
+
+// Вариант 2 с воспроизводимой нормой: error собирается блоками по индексу
+// и фиксированным деревом (reduce.h), поэтому момент остановки и решение
+// побитово одинаковы при любом числе потоков
+std::vector<double> jacobi_method_reproducible(const Matrix<double> &A, const std::vector<double> &b, int n, int max_iter, double tol) {
+    std::vector<double> x(n, 0.0), x_old(n, 0.0);
+    BlockReducer reducer(n);
+    #pragma omp parallel
+    {
+        for (int iter = 0; iter < max_iter; iter++) {
+            #pragma omp for
+            for (int i = 0; i < n; i++) {
+                const double* row = A.row(i);
+                double sigma = 0.0;
+                for (int j = 0; j < n; j++) {
+                    if (j != i)
+                        sigma += row[j] * x_old[j];
+                }
+                x[i] = (b[i] - sigma) / A[i][i];
             }
+            double error = reducer.sum([&](long i) { return std::abs(x[i] - x_old[i]); });
             if (error < tol)
                 break;
             #pragma omp single
@@ -68,7 +133,56 @@ std::vector<double> jacobi_method_parallel2(const std::vector<std::vector<double
     return x;
 }
 
-std::vector<double> jacobi_method_schedule(const std::vector<std::vector<double>> &A, const std::vector<double> &b, int n, int max_iter, double tol, const std::string& schedule_type) {
+// Вариант 2 с одним барьером на итерацию: новое значение и вклад в норму
+// считаются в одном цикле, буферы x/x_old меняются указателями (у каждого
+// потока свои, меняются одинаково), частичные суммы потоков лежат в своих
+// строках кэша, в двух наборах по чётности итерации — набор этой итерации
+// читается после барьера, пока следующая пишет в другой. Норму каждый поток
+// складывает сам в порядке номеров потоков — у всех одно и то же значение.
+std::vector<double> jacobi_method_fused(const Matrix<double> &A, const std::vector<double> &b, int n, int max_iter, double tol) {
+    struct alignas(64) Partial {
+        double value;
+    };
+    std::vector<double> buf[2] = {std::vector<double>(n, 0.0), std::vector<double>(n, 0.0)};
+    const int max_threads = omp_get_max_threads();
+    std::vector<Partial> partial(2 * max_threads);
+    int result = 0;
+    #pragma omp parallel
+    {
+        const int tid = omp_get_thread_num(), threads = omp_get_num_threads();
+        int cur = 1;  // x пишется в buf[cur], x_old — buf[cur ^ 1]
+        for (int iter = 0; iter < max_iter; iter++) {
+            const double* x_old = buf[cur ^ 1].data();
+            double* x = buf[cur].data();
+            double local = 0.0;
+            #pragma omp for schedule(static) nowait
+            for (int i = 0; i < n; i++) {
+                const double* row = A.row(i);
+                double sigma = 0.0;
+                for (int j = 0; j < n; j++) {
+                    if (j != i)
+                        sigma += row[j] * x_old[j];
+                }
+                x[i] = (b[i] - sigma) / row[i];
+                local += std::abs(x[i] - x_old[i]);
+            }
+            Partial* sums = partial.data() + (iter & 1) * max_threads;
+            sums[tid].value = local;
+            #pragma omp barrier
+            double error = 0.0;
+            for (int t = 0; t < threads; t++)
+                error += sums[t].value;
+            if (error < tol || iter + 1 == max_iter)
+                break;
+            cur ^= 1;
+        }
+        #pragma omp master
+        result = cur;
+    }
+    return std::move(buf[result]);
+}
+
+std::vector<double> jacobi_method_schedule(const Matrix<double> &A, const std::vector<double> &b, int n, int max_iter, double tol, const std::string& schedule_type) {
     std::vector<double> x(n, 0.0), x_old(n, 0.0);
     omp_sched_t schedule;
     if (schedule_type == "static")
@@ -78,23 +192,26 @@ std::vector<double> jacobi_method_schedule(const std::vector<std::vector<double>
     else
         schedule = omp_sched_guided;
 
+    double error = 0.0;
     #pragma omp parallel
     {
         omp_set_schedule(schedule, 1);
         for (int iter = 0; iter < max_iter; iter++) {
+            #pragma omp single nowait
+            error = 0.0;
             #pragma omp for schedule(runtime)
             for (int i = 0; i < n; i++) {
+                const double* row = A.row(i);
                 double sigma = 0.0;
                 for (int j = 0; j < n; j++) {
                     if (j != i)
-                        sigma += A[i][j] * x_old[j];
+                        sigma += row[j] * x_old[j];
                 }
                 x[i] = (b[i] - sigma) / A[i][i];
             }
-            double error = 0.0;
             #pragma omp for reduction(+:error)
             for (int i = 0; i < n; i++) {
-                error += abs(x[i] - x_old[i]);
+                error += std::abs(x[i] - x_old[i]);
             }
             if (error < tol)
                 break;
@@ -105,102 +222,486 @@ std::vector<double> jacobi_method_schedule(const std::vector<std::vector<double>
     return x;
 }
 
-int main() {
-    int n = 40000; // Размер системы
-    int max_iter = 1000;
-    double tol = 1e-6;
-    int threads[8] = {1, 2, 4, 7, 8, 16, 20, 40};
-    double start;
-    double end;
-    std::vector<double> x;
-    std::vector<std::vector<double>> A(n, std::vector<double>(n, 0.0));
-    std::vector<double> b(n, 0.0);
-    
-    initialize_matrix(A, b, n);
-    std::cout << "Вариант 1" <<std::endl;
-    omp_set_num_threads(1);
-    start = omp_get_wtime();
-    x = jacobi_method_parallel1(A, b, n, max_iter, tol);
-    end = omp_get_wtime();
-    std::cout << "T" << 1 <<" = " << end - start << std::endl;
-    double T1 = end - start;
-
-    //первый вариант
-    for (int i = 1; i < 8; i++) {
-        omp_set_num_threads(threads[i]);
-        start = omp_get_wtime();
-        x = jacobi_method_parallel1(A, b, n, max_iter, tol);
-        end = omp_get_wtime();
-        std::cout << "T" << threads[i] <<" = " << end - start << ", S" << threads[i] << " = " << T1/(end - start) << std::endl;
+// Вариант 1 для матрицы в файле: на каждой итерации матрица целиком
+// проходит через окно из двух тайлов. В io_bytes — прочитанный объём.
+std::vector<double> jacobi_method_mapped(const MappedMatrix<double> &A, const std::vector<double> &b, int n, int max_iter, double tol,
+                                         size_t window_bytes, double &io_bytes) {
+    std::vector<double> x(n, 0.0), x_old(n, 0.0);
+    const size_t tile_rows = tile_rows_for(A, window_bytes);
+    io_bytes = 0;
+    for (int iter = 0; iter < max_iter; iter++) {
+        io_bytes += for_each_tile(A, tile_rows, false, [&](size_t r0, size_t r1) {
+            #pragma omp parallel for
+            for (long i = (long)r0; i < (long)r1; i++) {
+                const double* row = A.row(i);
+                double sigma = 0.0;
+                for (int j = 0; j < n; j++) {
+                    if (j != i)
+                        sigma += row[j] * x_old[j];
+                }
+                x[i] = (b[i] - sigma) / row[i];
+            }
+        });
+        double error = 0.0;
+        #pragma omp parallel for reduction(+:error)
+        for (int i = 0; i < n; i++) {
+            error += std::abs(x[i] - x_old[i]);
+        }
+        if (error < tol)
+            break;
+        x_old = x;
+    }
+    return x;
+}
+
+// Та же матрица I + 11ᵀ в виде множителей: O(n) памяти
+LowRankMatrix initialize_matrix_lowrank(std::vector<double> &b, int n) {
+    LowRankMatrix A(n, 1);
+    for (int i = 0; i < n; i++) {
+        b[i] = i + 1;
+        A.d()[i] = 1.0;
+        A.U()(i, 0) = 1.0;
+        A.V()(i, 0) = 1.0;
+    }
+    return A;
+}
+
+// Вариант 2 на множителях: sigma_i = (U·Vᵀx)_i − u_i·v_i·x_i, Vᵀx считается
+// один раз за итерацию, поэтому итерация стоит O(n·r) вместо O(n²)
+std::vector<double> jacobi_method_lowrank(const LowRankMatrix &A, const std::vector<double> &b, int n, int max_iter, double tol) {
+    std::vector<double> x(n, 0.0), x_old(n, 0.0), t;
+    const size_t r = A.rank();
+    double error = 0.0;
+    #pragma omp parallel
+    {
+        for (int iter = 0; iter < max_iter; iter++) {
+            #pragma omp single nowait
+            error = 0.0;
+            A.project(x_old.data(), t);
+            #pragma omp for
+            for (int i = 0; i < n; i++) {
+                const double* u = A.U().row(i);
+                const double* v = A.V().row(i);
+                double ut = 0.0, uv = 0.0;
+                for (size_t k = 0; k < r; k++) {
+                    ut += u[k] * t[k];
+                    uv += u[k] * v[k];
+                }
+                double sigma = ut - uv * x_old[i];
+                x[i] = (b[i] - sigma) / (A.d()[i] + uv);
+            }
+            #pragma omp for reduction(+:error)
+            for (int i = 0; i < n; i++) {
+                error += std::abs(x[i] - x_old[i]);
+            }
+            if (error < tol)
+                break;
+            #pragma omp single
+            x_old = x;
+        }
     }
-    std::cout << "Вариант 2" <<std::endl;
-    omp_set_num_threads(1);
-    start = omp_get_wtime();
-    x = jacobi_method_parallel2(A, b, n, max_iter, tol);
-    end = omp_get_wtime();
-    std::cout << "T" << 1 <<" = " << end - start << std::endl;
-    T1 = end - start;
-
-    //второй вариант
-    for (int i = 1; i < 8; i++) {
-        omp_set_num_threads(threads[i]);
-        start = omp_get_wtime();
-        x = jacobi_method_parallel2(A, b, n, max_iter, tol);
-        end = omp_get_wtime();
-        std::cout << "T" << threads[i] <<" = " << end - start << ", S" << threads[i] << " = " << T1/(end - start) << std::endl;
+    return x;
+}
+
+// Вариант 2 на любом операторе: sigma_i = (A·x_old)_i − a_ii·x_old_i, поэтому
+// хватает apply и диагонали; цена итерации — цена apply плюс O(n).
+// В sweeps (если задан) — число сделанных итераций
+std::vector<double> jacobi_method_operator(const LinearOperator &A, const std::vector<double> &b, int n, int max_iter, double tol,
+                                           int *sweeps = nullptr) {
+    std::vector<double> x(n, 0.0), x_old(n, 0.0), y(n), d(n);
+    for (int i = 0; i < n; i++)
+        d[i] = A.diagonal(i);
+    double error = 0.0;
+    int done = max_iter;
+    #pragma omp parallel
+    {
+        for (int iter = 0; iter < max_iter; iter++) {
+            #pragma omp single nowait
+            error = 0.0;
+            A.apply(x_old.data(), y.data());
+            #pragma omp for reduction(+:error)
+            for (int i = 0; i < n; i++) {
+                x[i] = (b[i] - (y[i] - d[i] * x_old[i])) / d[i];
+                error += std::abs(x[i] - x_old[i]);
+            }
+            if (error < tol) {
+                #pragma omp master
+                done = iter + 1;
+                break;
+            }
+            #pragma omp single
+            x_old = x;
+        }
     }
+    if (sweeps)
+        *sweeps = done;
+    return x;
+}
 
-    //тесты schedule
-    std::cout << "тесты schedule\n" <<std::endl;
-    std::cout << "static" <<std::endl;
-    //static
-    omp_set_num_threads(1);
-    start = omp_get_wtime();
-    x = jacobi_method_schedule(A, b, n, max_iter, tol, "static");
-    end = omp_get_wtime();
-    std::cout << "T" << 1 <<" = " << end - start << std::endl;
-    T1 = end - start;
-        for (int i = 1; i < 8; i++) {
-        omp_set_num_threads(threads[i]);
-        start = omp_get_wtime();
-        x = jacobi_method_schedule(A, b, n, max_iter, tol, "static");
-        end = omp_get_wtime();
-        std::cout << "T" << threads[i] <<" = " << end - start << ", S" << threads[i] << " = " << T1/(end - start) << std::endl;
+// Вариант 2 на CSR: проход только по ненулям строки, без ветки j != i —
+// диагональ вычитается после (sigma = Σ a_ij·x_j − a_ii·x_i); новое
+// значение и норма считаются в одном цикле
+std::vector<double> jacobi_method_csr(const CsrMatrix &A, const std::vector<double> &b, int n, int max_iter, double tol) {
+    std::vector<double> x(n, 0.0), x_old(n, 0.0), d = csr_diagonal(A);
+    double error = 0.0;
+    #pragma omp parallel
+    {
+        for (int iter = 0; iter < max_iter; iter++) {
+            // здесь между сбросом и редукцией другого барьера нет — single с барьером,
+            // иначе быстрый поток успел бы добавить свою долю до обнуления
+            #pragma omp single
+            error = 0.0;
+            #pragma omp for reduction(+:error)
+            for (int i = 0; i < n; i++) {
+                double sigma = -d[i] * x_old[i];
+                for (long k = A.row_ptr[i]; k < A.row_ptr[i + 1]; k++)
+                    sigma += A.val[k] * x_old[A.col[k]];
+                x[i] = (b[i] - sigma) / d[i];
+                error += std::abs(x[i] - x_old[i]);
+            }
+            if (error < tol)
+                break;
+            #pragma omp single
+            x_old = x;
+        }
     }
+    return x;
+}
 
-    std::cout << "dynamic" <<std::endl;
-    //dynamic
-    omp_set_num_threads(1);
-    start = omp_get_wtime();
-    x = jacobi_method_schedule(A, b, n, max_iter, tol, "dynamic");
-    end = omp_get_wtime();
-    std::cout << "T" << 1 <<" = " << end - start << std::endl;
-    T1 = end - start;
-        for (int i = 1; i < 8; i++) {
-        omp_set_num_threads(threads[i]);
-        start = omp_get_wtime();
-        x = jacobi_method_schedule(A, b, n, max_iter, tol, "dynamic");
-        end = omp_get_wtime();
-        std::cout << "T" << threads[i] <<" = " << end - start << ", S" << threads[i] << " = " << T1/(end - start) << std::endl;
+// Наибольшее относительное расхождение двух решений; NaN/inf не теряется
+// (std::max(diff, NaN) вернул бы diff) — расходящееся решение проваливает сверку
+double max_rel_diff(const std::vector<double> &x1, const std::vector<double> &x2) {
+    double diff = 0;
+    for (size_t i = 0; i < x1.size(); i++) {
+        double d = std::abs(x1[i] - x2[i]) / std::max(1.0, std::abs(x1[i]));
+        if (!(d <= diff))
+            diff = d;
     }
+    return diff;
+}
+
+// Система n×n, общая для всех вариантов одного размера
+struct System {
+    Matrix<double> A;
+    std::vector<double> b;
+    System(int n, PagePolicy pages) : A(n, n, pages), b(n, 0.0) { initialize_matrix(A, b, n); }
+};
 
-    std::cout << "guided" <<std::endl;
-    //guided
-    omp_set_num_threads(1);
-    start = omp_get_wtime();
-    x = jacobi_method_schedule(A, b, n, max_iter, tol, "guided");
-    end = omp_get_wtime();
-    std::cout << "T" << 1 <<" = " << end - start << std::endl;
-    T1 = end - start;
-        for (int i = 1; i < 8; i++) {
-        omp_set_num_threads(threads[i]);
-        start = omp_get_wtime();
-        x = jacobi_method_schedule(A, b, n, max_iter, tol, "guided");
-        end = omp_get_wtime();
-        std::cout << "T" << threads[i] <<" = " << end - start << ", S" << threads[i] << " = " << T1/(end - start) << std::endl;
+typedef std::function<std::vector<double>(const Matrix<double>&, const std::vector<double>&, int n, int max_iter, double tol)> Solver;
+
+int main(int argc, char** argv) {
+    Harness h(argc, argv, {40000}, {1, 2, 4, 7, 8, 16, 20, 40});
+    // --perf: счётчики каждого потока OpenMP вокруг каждого замера
+    PerfProbe perf;
+    if (h.flag("perf"))
+        h.probe(&perf);
+    // --affinity: перебор политик привязки потоков
+    add_affinity_sweep(h);
+    const int max_iter = h.option("max-iter", 1000);
+    const double tol = h.option("tol", 1e-6);
+
+    // --pages small,thp,hugetlb — каждый решатель на матрице с разными страницами
+    const std::vector<std::string> pages = h.list("pages", "thp");
+
+    std::shared_ptr<System> system;
+    PagePolicy system_pages = PagePolicy::Small;
+    auto system_for = [&](long n, PagePolicy p) {
+        if (!system || (long)system->b.size() != n || system_pages != p) {
+            system.reset();
+            system = std::make_shared<System>((int)n, p);
+            system_pages = p;
+        }
+        return system;
+    };
+
+    const std::vector<std::pair<std::string, Solver>> solvers = {
+        {"jacobi1", jacobi_method_parallel1},
+        {"jacobi2", jacobi_method_parallel2},
+        {"reproducible", jacobi_method_reproducible},
+        {"fused", jacobi_method_fused},
+        {"static", [](const Matrix<double>& A, const std::vector<double>& b, int n, int max_iter, double tol) {
+             return jacobi_method_schedule(A, b, n, max_iter, tol, "static"); }},
+        {"dynamic", [](const Matrix<double>& A, const std::vector<double>& b, int n, int max_iter, double tol) {
+             return jacobi_method_schedule(A, b, n, max_iter, tol, "dynamic"); }},
+        {"guided", [](const Matrix<double>& A, const std::vector<double>& b, int n, int max_iter, double tol) {
+             return jacobi_method_schedule(A, b, n, max_iter, tol, "guided"); }},
+    };
+    for (const std::string& page : pages) {
+        const PagePolicy policy = page_policy_from_name(page, PagePolicy::Transparent);
+        for (auto& solver : solvers) {
+            h.add(pages.size() > 1 ? solver.first + "/" + page : solver.first, [&, solver, policy](long n) {
+                std::shared_ptr<System> sys = system_for(n, policy);
+                Case c;
+                c.run = [=](int threads) {
+                    omp_set_num_threads(threads);
+                    double start = omp_get_wtime();
+                    solver.second(sys->A, sys->b, (int)n, max_iter, tol);
+                    return omp_get_wtime() - start;
+                };
+                c.tags = {{"pages", page_policy_name(sys->A.pages())}};
+                return c;
+            });
+        }
     }
 
+    // Матрица множителями; до --check-max решение сверяется с jacobi2 на плотной копии.
+    // На самой I + 11ᵀ Якоби расходится (ρ = (n − 1) / 2) и сверять нечего, поэтому
+    // сверка — на той же структуре с диагональным преобладанием: d = 2n, ρ ≈ 1/2
+    const long check_max = h.option("check-max", 2000L);
+    h.add("lowrank", [&](long n) {
+        auto b = std::make_shared<std::vector<double>>(n);
+        auto A = std::make_shared<LowRankMatrix>(initialize_matrix_lowrank(*b, (int)n));
+        const bool checked = n <= check_max;
+        double diff = 0;
+        if (checked) {
+            LowRankMatrix dominant = initialize_matrix_lowrank(*b, (int)n);
+            for (long i = 0; i < n; i++)
+                dominant.d()[i] = 2.0 * n;
+            Matrix<double> dense(n, n);
+            dominant.to_dense(dense, omp_get_max_threads());
+            std::vector<double> x1 = jacobi_method_parallel2(dense, *b, (int)n, max_iter, tol);
+            std::vector<double> x2 = jacobi_method_lowrank(dominant, *b, (int)n, max_iter, tol);
+            diff = max_rel_diff(x1, x2);
+        }
+        Case c;
+        c.run = [=, &h](int threads) {
+            if (checked)
+                h.metric("diff vs dense", diff);
+            omp_set_num_threads(threads);
+            double start = omp_get_wtime();
+            jacobi_method_lowrank(*A, *b, (int)n, max_iter, tol);
+            return omp_get_wtime() - start;
+        };
+        c.tags = {{"rank", std::to_string(A->rank())}};
+        return c;
+    });
+
+    // Решатель на операторах (размер — число неизвестных):
+    //   op/dense, op/closed — матрица лабы плотной и как I + 11ᵀ,
+    //   op/stencil, op/csr  — лапласиан на сетке m×m, m = √n, b = 1
+    // До --check-max op/closed сверяется с jacobi2 на плотной 2n·I + 11ᵀ.
+    // cg/<оператор>, pcg/<оператор> — сопряжённые градиенты на тех же операторах,
+    // gs/<оператор>, sor/<оператор> — красно-чёрные Гаусс–Зейдель и SOR, только
+    // для stencil и csr: у плотной матрицы лабы все строки связаны, двух цветов с
+    // независимыми строками нет (relax = false)
+    // (op/dense — тот же jacobi2, но с числом итераций в sweeps)
+    const double omega_option = h.option("omega", 0.0);
+    const int power_iters = h.option("power-iters", 50);
+    auto add_operator = [&](const std::string& name, std::function<std::shared_ptr<LinearOperator>(long, std::vector<double>&)> make,
+                            bool relax) {
+        h.add("op/" + name, [&, name, make](long n) {
+            auto b = std::make_shared<std::vector<double>>();
+            std::shared_ptr<LinearOperator> A = make(n, *b);
+            const long rows = A->rows();
+            double diff = -1;
+            if (name == "closed" && n <= check_max) {
+                // как у lowrank: I + 11ᵀ у Якоби расходится, сверка — на 2n·I + 11ᵀ
+                ClosedFormOperator dominant(n, 2.0 * n, 1.0);
+                Matrix<double> dense(n, n);
+                for (long i = 0; i < n; i++)
+                    for (long j = 0; j < n; j++)
+                        dense(i, j) = i == j ? 2.0 * n + 1.0 : 1.0;
+                std::vector<double> x1 = jacobi_method_parallel2(dense, *b, (int)n, max_iter, tol);
+                std::vector<double> x2 = jacobi_method_operator(dominant, *b, (int)n, max_iter, tol);
+                diff = max_rel_diff(x1, x2);
+            }
+            Case c;
+            c.run = [=, &h](int threads) {
+                if (diff >= 0)
+                    h.metric("diff vs dense", diff);
+                omp_set_num_threads(threads);
+                int sweeps;
+                double start = omp_get_wtime();
+                jacobi_method_operator(*A, *b, (int)rows, max_iter, tol, &sweeps);
+                double t = omp_get_wtime() - start;
+                h.metric("sweeps", sweeps);
+                return t;
+            };
+            c.tags = {{"rows", std::to_string(rows)}};
+            return c;
+        });
+        // Тот же оператор — CG и CG с предобусловливателем Якоби; останов по ‖r‖ ≤ tol·‖b‖
+        for (bool precondition : {false, true}) {
+            h.add((precondition ? "pcg/" : "cg/") + name, [&, make, precondition](long n) {
+                auto b = std::make_shared<std::vector<double>>();
+                std::shared_ptr<LinearOperator> A = make(n, *b);
+                const long rows = A->rows();
+                Case c;
+                c.run = [=, &h](int threads) {
+                    omp_set_num_threads(threads);
+                    int iterations;
+                    double residual;
+                    double start = omp_get_wtime();
+                    cg_method(*A, *b, (int)rows, max_iter, tol, precondition, iterations, residual);
+                    double t = omp_get_wtime() - start;
+                    h.metric("iterations", iterations);
+                    h.metric("residual", residual);
+                    return t;
+                };
+                c.tags = {{"rows", std::to_string(rows)}};
+                return c;
+            });
+        }
+        // Красно-чёрные Гаусс–Зейдель (ω = 1) и SOR: ω из --omega или, по
+        // умолчанию, по оценке ρ матрицы Якоби за --power-iters шагов (вне замера)
+        for (bool sor : {false, true}) {
+            if (!relax)
+                break;
+            h.add((sor ? "sor/" : "gs/") + name, [&, make, sor](long n) {
+                auto b = std::make_shared<std::vector<double>>();
+                std::shared_ptr<LinearOperator> A = make(n, *b);
+                const long rows = A->rows();
+                double rho = -1, omega = 1.0;
+                if (sor) {
+                    omega = omega_option;
+                    if (omega <= 0.0) {
+                        rho = jacobi_spectral_radius(*A, power_iters);
+                        omega = optimal_omega(rho);
+                    }
+                }
+                Case c;
+                c.run = [=, &h](int threads) {
+                    omp_set_num_threads(threads);
+                    int sweeps;
+                    double start = omp_get_wtime();
+                    sor_method(*A, *b, (int)rows, max_iter, tol, omega, sweeps);
+                    double t = omp_get_wtime() - start;
+                    h.metric("sweeps", sweeps);
+                    h.metric("omega", omega);
+                    if (rho >= 0)
+                        h.metric("rho", rho);
+                    return t;
+                };
+                c.tags = {{"rows", std::to_string(rows)}};
+                return c;
+            });
+        }
+    };
+    add_operator("dense", [&](long n, std::vector<double>& b) {
+        std::shared_ptr<System> sys = system_for(n, PagePolicy::Transparent);
+        b = sys->b;
+        // оператор ссылается на матрицу — система живёт, пока жив он
+        return std::shared_ptr<LinearOperator>(new DenseOperator(sys->A), [sys](LinearOperator* p) { delete p; });
+    }, false);
+    add_operator("closed", [](long n, std::vector<double>& b) {
+        b.resize(n);
+        for (long i = 0; i < n; i++)
+            b[i] = i + 1;
+        return std::make_shared<ClosedFormOperator>(n, 1.0, 1.0);
+    }, false);
+    add_operator("stencil", [](long n, std::vector<double>& b) {
+        const int m = (int)std::lround(std::sqrt((double)n));
+        b.assign((long)m * m, 1.0);
+        return std::make_shared<StencilOperator>(m);
+    }, true);
+    add_operator("csr", [](long n, std::vector<double>& b) {
+        const int m = (int)std::lround(std::sqrt((double)n));
+        b.assign((long)m * m, 1.0);
+        auto A = std::make_shared<CsrMatrix>(poisson2d_csr(m));
+        return std::shared_ptr<LinearOperator>(new CsrOperator(*A), [A](LinearOperator* p) { delete p; });
+    }, true);
 
+    // Разреженные: --mtx файл.mtx (Matrix Market) или лапласиан на сетке √n×√n.
+    //   spmv/csr, spmv/sell — --spmv-iters умножений за прогон (SELL-C-σ:
+    //   --sell-c 8, --sell-sigma 256), jacobi/csr — Якоби по ненулям, b = 1.
+    // GB/s — минимальный трафик: матрица, x и y по разу за умножение
+    const std::string mtx_path = h.option("mtx", "");
+    const int spmv_iters = h.option("spmv-iters", 100);
+    const int sell_c = h.option("sell-c", 8), sell_sigma = h.option("sell-sigma", 256);
+    std::shared_ptr<CsrMatrix> sparse;
+    auto sparse_for = [&](long n) {
+        const long m = std::lround(std::sqrt((double)n));
+        if (!mtx_path.empty()) {
+            if (!sparse)
+                sparse = std::make_shared<CsrMatrix>(read_matrix_market(mtx_path));
+        } else if (!sparse || sparse->n != m * m) {
+            sparse = std::make_shared<CsrMatrix>(poisson2d_csr((int)m));
+        }
+        return sparse;
+    };
+    h.add("spmv/csr", [&](long n) {
+        std::shared_ptr<CsrMatrix> A = sparse_for(n);
+        auto x = std::make_shared<std::vector<double>>(A->n, 1.0), y = std::make_shared<std::vector<double>>(A->n);
+        const double bytes = A->nnz() * (8.0 + 4.0) + (A->n + 1) * 8.0 + 2.0 * A->n * 8.0;
+        Case c;
+        c.run = [=](int threads) {
+            double start = omp_get_wtime();
+            #pragma omp parallel num_threads(threads)
+            for (int it = 0; it < spmv_iters; it++)
+                csr_spmv(*A, x->data(), y->data());
+            return omp_get_wtime() - start;
+        };
+        c.rates = {{"Gnnz/s", spmv_iters * A->nnz() / 1e9}, {"GB/s", spmv_iters * bytes / 1e9}};
+        c.tags = {{"rows", std::to_string(A->n)}, {"nnz", std::to_string(A->nnz())}};
+        return c;
+    });
+    h.add("spmv/sell", [&](long n) {
+        std::shared_ptr<CsrMatrix> A = sparse_for(n);
+        auto S = std::make_shared<SellMatrix>(sell_from_csr(*A, sell_c, sell_sigma));
+        auto x = std::make_shared<std::vector<double>>(A->n), y = std::make_shared<std::vector<double>>(A->n);
+        // сверка с CSR на неоднородном x
+        std::vector<double> y_csr(A->n);
+        for (long i = 0; i < A->n; i++)
+            (*x)[i] = 1.0 + 1e-3 * (i % 97);
+        double diff = 0.0;
+        #pragma omp parallel
+        {
+            csr_spmv(*A, x->data(), y_csr.data());
+            sell_spmv(*S, x->data(), y->data());
+        }
+        for (long i = 0; i < A->n; i++)
+            diff = std::max(diff, std::abs((*y)[i] - y_csr[i]));
+        const double bytes = S->slots() * (8.0 + 4.0) + S->chunks() * (8.0 + 4.0) + S->perm.size() * 4.0 + 2.0 * A->n * 8.0;
+        Case c;
+        c.run = [=, &h](int threads) {
+            h.metric("diff vs csr", diff);
+            double start = omp_get_wtime();
+            #pragma omp parallel num_threads(threads)
+            for (int it = 0; it < spmv_iters; it++)
+                sell_spmv(*S, x->data(), y->data());
+            return omp_get_wtime() - start;
+        };
+        c.rates = {{"Gnnz/s", spmv_iters * A->nnz() / 1e9}, {"GB/s", spmv_iters * bytes / 1e9}};
+        c.tags = {{"rows", std::to_string(A->n)}, {"nnz", std::to_string(A->nnz())},
+                  {"fill", std::to_string((double)S->slots() / std::max(1L, A->nnz()))}};
+        return c;
+    });
+    h.add("jacobi/csr", [&](long n) {
+        std::shared_ptr<CsrMatrix> A = sparse_for(n);
+        csr_diagonal(*A);  // без ненулевой диагонали — ошибка до замеров
+        auto b = std::make_shared<std::vector<double>>(A->n, 1.0);
+        Case c;
+        c.run = [=](int threads) {
+            omp_set_num_threads(threads);
+            double start = omp_get_wtime();
+            jacobi_method_csr(*A, *b, (int)A->n, max_iter, tol);
+            return omp_get_wtime() - start;
+        };
+        c.tags = {{"rows", std::to_string(A->n)}, {"nnz", std::to_string(A->nnz())}};
+        return c;
+    });
 
-    return 0;
+    // --mmap файл [--window-mb M] — вариант 1 на матрице в файле
+    const std::string mmap_path = h.option("mmap", "");
+    const size_t window_bytes = (size_t)h.option("window-mb", 512L) << 20;
+    if (!mmap_path.empty()) {
+        h.add("mmap", [&](long n) {
+            auto A = std::make_shared<MappedMatrix<double>>(mmap_path, n, n);
+            auto b = std::make_shared<std::vector<double>>(n, 0.0);
+            initialize_matrix_mapped(*A, *b, (int)n, window_bytes);
+            Case c;
+            c.run = [=, &h](int threads) {
+                omp_set_num_threads(threads);
+                double io_bytes;
+                double start = omp_get_wtime();
+                jacobi_method_mapped(*A, *b, (int)n, max_iter, tol, window_bytes, io_bytes);
+                double t = omp_get_wtime() - start;
+                h.metric("disk GB/s", io_bytes / 1e9 / t);
+                return t;
+            };
+            c.tags = {{"window-mb", std::to_string(window_bytes >> 20)}};
+            return c;
+        });
+    }
+    return h.run();
 }
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+#include <omp.h>
+#include "matrix.h"
+#include "reduce.h"
+#include "sparse.h"
+
+// Линейный оператор для решателей: только y = A·x и диагональ, хранение —
+// дело реализации. apply вызывают все потоки команды внутри параллельного
+// региона (orphaned omp for), по выходу y готов у всех (барьер omp for).
+class LinearOperator {
+public:
+    virtual ~LinearOperator() {}
+    virtual long rows() const = 0;
+    virtual void apply(const double* x, double* y) const = 0;
+    virtual double diagonal(long i) const = 0;
+    // Необязательный доступ по строкам: Σ_j a_ij·x_j для одной строки
+    virtual bool has_rows() const { return false; }
+    virtual double row_dot(long /*i*/, const double* /*x*/) const { return 0.0; }
+    // Две краски для красно-чёрных схем: строки одного цвета не связаны друг
+    // с другом (у стенсила — шахматка). Без такой раскраски (has_coloring()
+    // == false) красно-чёрный ход — не Гаусс–Зейдель, а Якоби внутри цвета
+    virtual bool has_coloring() const { return false; }
+    virtual int color(long i) const { return (int)(i & 1); }
+};
+
+// Плотная матрица: n² на применение
+class DenseOperator : public LinearOperator {
+public:
+    explicit DenseOperator(const Matrix<double>& A) : A_(A) {}
+    long rows() const override { return (long)A_.rows(); }
+    void apply(const double* x, double* y) const override {
+        const long n = rows();
+        #pragma omp for schedule(static)
+        for (long i = 0; i < n; i++)
+            y[i] = row_dot(i, x);
+    }
+    double diagonal(long i) const override { return A_(i, i); }
+    bool has_rows() const override { return true; }
+    double row_dot(long i, const double* x) const override {
+        const double* row = A_.row(i);
+        const long n = rows();
+        double s = 0.0;
+        for (long j = 0; j < n; j++)
+            s += row[j] * x[j];
+        return s;
+    }
+
+private:
+    const Matrix<double>& A_;
+};
+
+// CSR: nnz на применение
+class CsrOperator : public LinearOperator {
+public:
+    explicit CsrOperator(const CsrMatrix& A) : A_(A), diag_(csr_diagonal(A)) { color_graph(); }
+    long rows() const override { return A_.n; }
+    void apply(const double* x, double* y) const override {
+        #pragma omp for schedule(static)
+        for (long i = 0; i < A_.n; i++)
+            y[i] = row_dot(i, x);
+    }
+    double diagonal(long i) const override { return diag_[i]; }
+    bool has_rows() const override { return true; }
+    double row_dot(long i, const double* x) const override {
+        double s = 0.0;
+        for (long k = A_.row_ptr[i]; k < A_.row_ptr[i + 1]; k++)
+            s += A_.val[k] * x[A_.col[k]];
+        return s;
+    }
+
+    bool has_coloring() const override { return bipartite_; }
+    int color(long i) const override { return color_[i]; }
+
+private:
+    // Две краски обходом в ширину по графу ненулей (связи берутся как
+    // неориентированные); если граф не двудольный — чётность номера строки
+    // и has_coloring() == false
+    void color_graph() {
+        const long n = A_.n;
+        bipartite_ = true;
+        color_.assign(n, -1);
+        std::vector<long> queue;
+        queue.reserve(n);
+        for (long s = 0; s < n; s++) {
+            if (color_[s] >= 0)
+                continue;
+            color_[s] = 0;
+            queue.assign(1, s);
+            for (size_t q = 0; q < queue.size(); q++) {
+                const long i = queue[q];
+                for (long k = A_.row_ptr[i]; k < A_.row_ptr[i + 1]; k++) {
+                    const long j = A_.col[k];
+                    if (j == i)
+                        continue;
+                    if (color_[j] < 0) {
+                        color_[j] = (signed char)(color_[i] ^ 1);
+                        queue.push_back(j);
+                    } else if (color_[j] == color_[i]) {
+                        for (long r = 0; r < n; r++)
+                            color_[r] = (signed char)(r & 1);
+                        bipartite_ = false;
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    const CsrMatrix& A_;
+    std::vector<double> diag_;
+    std::vector<signed char> color_;
+    bool bipartite_ = true;
+};
+
+// Пятиточечный лапласиан на сетке m×m без хранения (та же матрица, что poisson2d_csr)
+class StencilOperator : public LinearOperator {
+public:
+    explicit StencilOperator(int m) : m_(m) {}
+    long rows() const override { return (long)m_ * m_; }
+    void apply(const double* x, double* y) const override {
+        const int m = m_;
+        #pragma omp for schedule(static)
+        for (int i = 0; i < m; i++) {
+            const double* c = x + (long)i * m;
+            double* out = y + (long)i * m;
+            // соседи — отдельными проходами по строке (она в L1), без условий в цикле
+            #pragma omp simd
+            for (int j = 0; j < m; j++)
+                out[j] = 4.0 * c[j];
+            if (i > 0) {
+                #pragma omp simd
+                for (int j = 0; j < m; j++)
+                    out[j] -= c[j - m];
+            }
+            if (i + 1 < m) {
+                #pragma omp simd
+                for (int j = 0; j < m; j++)
+                    out[j] -= c[j + m];
+            }
+            #pragma omp simd
+            for (int j = 1; j < m; j++)
+                out[j] -= c[j - 1];
+            #pragma omp simd
+            for (int j = 0; j < m - 1; j++)
+                out[j] -= c[j + 1];
+        }
+    }
+    double diagonal(long) const override { return 4.0; }
+    bool has_rows() const override { return true; }
+    double row_dot(long r, const double* x) const override {
+        const long i = r / m_, j = r % m_;
+        double s = 4.0 * x[r];
+        if (i > 0)
+            s -= x[r - m_];
+        if (i + 1 < m_)
+            s -= x[r + m_];
+        if (j > 0)
+            s -= x[r - 1];
+        if (j + 1 < m_)
+            s -= x[r + 1];
+        return s;
+    }
+    bool has_coloring() const override { return true; }
+    int color(long r) const override { return (int)((r / m_ + r % m_) & 1); }
+    int grid() const { return m_; }
+
+private:
+    int m_;
+};
+
+// αI + β·11ᵀ в замкнутом виде: y = α·x + β·Σx, O(n) на применение.
+// Матрица лабы (2 на диагонали, 1 вне её) — α = β = 1
+class ClosedFormOperator : public LinearOperator {
+public:
+    ClosedFormOperator(long n, double alpha, double beta) : n_(n), alpha_(alpha), beta_(beta), reducer_(n) {}
+    long rows() const override { return n_; }
+    void apply(const double* x, double* y) const override {
+        const double s = reducer_.sum([x](long i) { return x[i]; });
+        #pragma omp for schedule(static)
+        for (long i = 0; i < n_; i++)
+            y[i] = alpha_ * x[i] + beta_ * s;
+    }
+    double diagonal(long) const override { return alpha_ + beta_; }
+
+private:
+    long n_;
+    double alpha_, beta_;
+    mutable BlockReducer reducer_;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <omp.h>
+#include "operator.h"
+#include "reduce.h"
+
+// Красно-чёрный Гаусс–Зейдель и SOR на LinearOperator. Строки делятся на
+// два цвета (LinearOperator::color); за полуход сначала для всех строк цвета
+// считается y_i = Σ_j a_ij·x_j (row_dot, без доступа по строкам — apply),
+// затем x_i += ω·(b_i − y_i) / a_ii. Строки одного цвета должны быть
+// независимы (has_coloring: стенсил, CSR с двудольным графом) — тогда это в
+// точности Гаусс–Зейдель в красно-чёрном порядке; у связанных строк вышел бы
+// Якоби внутри цвета, который на плотной матрице лабы расходится, поэтому
+// такие операторы отвергаются. Условие останова то же, что у Якоби:
+// Σ|x_new − x_old| < tol за полный ход.
+
+// Спектральный радиус матрицы Якоби B = I − D⁻¹A степенным методом
+// (iters шагов); по нему — оптимальный ω = 2 / (1 + √(1 − ρ²))
+inline double jacobi_spectral_radius(const LinearOperator &A, int iters) {
+    const long n = A.rows();
+    std::vector<double> v(n), w(n), y(n), d(n);
+    for (long i = 0; i < n; i++) {
+        v[i] = 1.0 + 0.1 * (i % 7);
+        d[i] = A.diagonal(i);
+    }
+    BlockReducer reducer(n);
+    double rho = 0.0;
+    #pragma omp parallel
+    {
+        double norm = std::sqrt(reducer.sum([&](long i) { return v[i] * v[i]; }));
+        for (int k = 0; k <= iters; k++) {
+            #pragma omp for schedule(static)
+            for (long i = 0; i < n; i++)
+                v[i] /= norm;
+            if (k == iters)
+                break;
+            A.apply(v.data(), y.data());
+            #pragma omp for schedule(static)
+            for (long i = 0; i < n; i++)
+                w[i] = v[i] - y[i] / d[i];
+            // ‖v‖ = 1, поэтому ‖Bv‖ — оценка ρ
+            norm = std::sqrt(reducer.sum([&](long i) { return w[i] * w[i]; }));
+            #pragma omp single
+            {
+                v.swap(w);
+                rho = norm;
+            }
+        }
+    }
+    return rho;
+}
+
+inline double optimal_omega(double rho) { return rho < 1.0 ? 2.0 / (1.0 + std::sqrt(1.0 - rho * rho)) : 1.0; }
+
+// omega = 1 — Гаусс–Зейдель. В sweeps — число полных ходов
+inline std::vector<double> sor_method(const LinearOperator &A, const std::vector<double> &b, int n, int max_iter, double tol,
+                                      double omega, int &sweeps) {
+    if (!A.has_coloring())
+        throw std::runtime_error("sor_method: operator has no red-black colouring");
+    std::vector<double> x(n, 0.0), y(n), d(n);
+    std::vector<int> rows_of[2];
+    for (int i = 0; i < n; i++) {
+        d[i] = A.diagonal(i);
+        rows_of[A.color(i) & 1].push_back(i);
+    }
+    // Норма поправки копится в одну из двух ячеек по чётности хода: ячейку
+    // следующего хода можно обнулить, пока эту ещё читают
+    double error[2] = {0.0, 0.0};
+    int done = max_iter;
+    #pragma omp parallel
+    {
+        for (int iter = 0; iter < max_iter; iter++) {
+            const int p = iter & 1;
+            double local = 0.0;
+            for (int c = 0; c < 2; c++) {
+                const std::vector<int> &rows = rows_of[c];
+                const long cnt = (long)rows.size();
+                if (A.has_rows()) {
+                    #pragma omp for schedule(static)
+                    for (long k = 0; k < cnt; k++)
+                        y[rows[k]] = A.row_dot(rows[k], x.data());
+                } else {
+                    A.apply(x.data(), y.data());
+                }
+                if (c == 0) {
+                    #pragma omp single nowait
+                    error[p ^ 1] = 0.0;
+                }
+                // после второго цвета барьер ниже, вместе с редукцией
+                #pragma omp for schedule(static) nowait
+                for (long k = 0; k < cnt; k++) {
+                    const int i = rows[k];
+                    const double delta = omega * (b[i] - y[i]) / d[i];
+                    x[i] += delta;
+                    local += std::abs(delta);
+                }
+                if (c == 0) {
+                    #pragma omp barrier
+                }
+            }
+            #pragma omp atomic
+            error[p] += local;
+            #pragma omp barrier
+            if (error[p] < tol) {
+                #pragma omp master
+                done = iter + 1;
+                break;
+            }
+        }
+    }
+    sweeps = done;
+    return x;
+}
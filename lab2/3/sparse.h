@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <omp.h>
+
+// Разреженная матрица в формате CSR: строка i — элементы
+// [row_ptr[i], row_ptr[i + 1]) массивов col/val, столбцы по возрастанию
+struct CsrMatrix {
+    long n = 0;
+    std::vector<long> row_ptr;
+    std::vector<int> col;
+    std::vector<double> val;
+
+    long nnz() const { return (long)val.size(); }
+};
+
+// Диагональ CSR для Якоби и предобусловливателя; строка без ненулевого
+// a_ii дала бы деление на ноль и NaN на первой же итерации — ошибка
+inline std::vector<double> csr_diagonal(const CsrMatrix& A) {
+    std::vector<double> d(A.n, 0.0);
+    for (long i = 0; i < A.n; i++)
+        for (long k = A.row_ptr[i]; k < A.row_ptr[i + 1]; k++)
+            if (A.col[k] == i)
+                d[i] = A.val[k];
+    for (long i = 0; i < A.n; i++)
+        if (d[i] == 0.0)
+            throw std::runtime_error("csr_diagonal: row " + std::to_string(i + 1) + " has no nonzero diagonal entry");
+    return d;
+}
+
+// Пятиточечный лапласиан на сетке m×m (узел r = i·m + j): 4 на диагонали,
+// −1 у соседей по сетке
+inline CsrMatrix poisson2d_csr(int m) {
+    CsrMatrix A;
+    A.n = (long)m * m;
+    A.row_ptr.reserve(A.n + 1);
+    A.col.reserve(5 * A.n);
+    A.val.reserve(5 * A.n);
+    A.row_ptr.push_back(0);
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < m; j++) {
+            const int r = i * m + j;
+            auto put = [&](int c, double v) {
+                A.col.push_back(c);
+                A.val.push_back(v);
+            };
+            if (i > 0)
+                put(r - m, -1.0);
+            if (j > 0)
+                put(r - 1, -1.0);
+            put(r, 4.0);
+            if (j + 1 < m)
+                put(r + 1, -1.0);
+            if (i + 1 < m)
+                put(r + m, -1.0);
+            A.row_ptr.push_back((long)A.col.size());
+        }
+    }
+    return A;
+}
+
+// Matrix Market (coordinate, real/integer/pattern, general/symmetric) → CSR.
+// У симметричной в файле только нижний треугольник — отражается. Индексы
+// вне [1, rows] — ошибка; диагональ не проверяется (SpMV она не нужна),
+// это делает csr_diagonal у Якоби и CsrOperator.
+inline CsrMatrix read_matrix_market(const std::string& path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("read_matrix_market: cannot open " + path);
+    std::string line;
+    std::getline(in, line);
+    std::istringstream banner(line);
+    std::string head, object, format, field, symmetry;
+    banner >> head >> object >> format >> field >> symmetry;
+    if (head != "%%MatrixMarket" || format != "coordinate")
+        throw std::runtime_error("read_matrix_market: only coordinate format is supported: " + path);
+    if (field == "complex")
+        throw std::runtime_error("read_matrix_market: complex matrices are not supported: " + path);
+    const bool pattern = field == "pattern";
+    const bool symmetric = symmetry == "symmetric" || symmetry == "skew-symmetric";
+    const double mirror = symmetry == "skew-symmetric" ? -1.0 : 1.0;
+    while (std::getline(in, line) && (line.empty() || line[0] == '%')) {
+    }
+    long rows, cols, entries;
+    if (!(std::istringstream(line) >> rows >> cols >> entries) || rows != cols || rows < 0 || rows > INT_MAX ||
+        entries < 0)
+        throw std::runtime_error("read_matrix_market: bad size line or non-square matrix: " + path);
+
+    std::vector<std::tuple<int, int, double>> coo;
+    coo.reserve(symmetric ? 2 * entries : entries);
+    for (long e = 0; e < entries; e++) {
+        long i, j;
+        double v = 1.0;
+        if (!(in >> i >> j) || (!pattern && !(in >> v)))
+            throw std::runtime_error("read_matrix_market: truncated file: " + path);
+        if (i < 1 || i > rows || j < 1 || j > cols)
+            throw std::runtime_error("read_matrix_market: entry (" + std::to_string(i) + ", " + std::to_string(j) +
+                                     ") is out of range: " + path);
+        coo.emplace_back((int)(i - 1), (int)(j - 1), v);
+        if (symmetric && i != j)
+            coo.emplace_back((int)(j - 1), (int)(i - 1), mirror * v);
+    }
+    std::sort(coo.begin(), coo.end());
+
+    CsrMatrix A;
+    A.n = rows;
+    A.row_ptr.assign(rows + 1, 0);
+    A.col.reserve(coo.size());
+    A.val.reserve(coo.size());
+    for (size_t e = 0; e < coo.size(); e++) {
+        const auto [i, j, v] = coo[e];
+        // повторы одной позиции (после сортировки — соседи) складываются
+        if (e > 0 && std::get<0>(coo[e - 1]) == i && std::get<1>(coo[e - 1]) == j) {
+            A.val.back() += v;
+            continue;
+        }
+        A.col.push_back(j);
+        A.val.push_back(v);
+        A.row_ptr[i + 1] = (long)A.col.size();
+    }
+    // строки без элементов наследуют конец предыдущей
+    for (long i = 0; i < rows; i++)
+        A.row_ptr[i + 1] = std::max(A.row_ptr[i + 1], A.row_ptr[i]);
+    return A;
+}
+
+// y = A·x по строкам; вызывают все потоки команды (orphaned omp for)
+inline void csr_spmv(const CsrMatrix& A, const double* x, double* y) {
+    #pragma omp for schedule(static)
+    for (long i = 0; i < A.n; i++) {
+        double s = 0.0;
+        for (long k = A.row_ptr[i]; k < A.row_ptr[i + 1]; k++)
+            s += A.val[k] * x[A.col[k]];
+        y[i] = s;
+    }
+}
+
+// SELL-C-σ: строки внутри окна из σ штук сортируются по убыванию длины,
+// затем режутся на куски по C строк; кусок хранится по столбцам шириной в
+// самую длинную его строку (короткие добиваются нулями с col = своя строка).
+// Внутренний цикл идёт по C строкам куска разом и векторизуется (C ≤ 32),
+// а сортировка держит добивку малой.
+struct SellMatrix {
+    long n = 0;
+    int C = 8, sigma = 256;
+    std::vector<long> chunk_ptr;  // начало куска в col/val
+    std::vector<int> chunk_len;   // ширина куска
+    std::vector<int> perm;        // perm[c·C + l] — исходная строка (или −1 за концом)
+    std::vector<int> col;
+    std::vector<double> val;
+
+    long slots() const { return (long)val.size(); }
+    long chunks() const { return (long)chunk_len.size(); }
+};
+
+inline SellMatrix sell_from_csr(const CsrMatrix& A, int C = 8, int sigma = 256) {
+    SellMatrix S;
+    S.n = A.n;
+    S.C = C = std::min(std::max(C, 1), 32);
+    S.sigma = sigma;
+    const long chunks = (A.n + C - 1) / C;
+    S.perm.assign(chunks * C, -1);
+    std::iota(S.perm.begin(), S.perm.begin() + A.n, 0);
+    auto len = [&](int r) { return A.row_ptr[r + 1] - A.row_ptr[r]; };
+    for (long w = 0; w < A.n; w += sigma)
+        std::stable_sort(S.perm.begin() + w, S.perm.begin() + std::min(A.n, w + sigma),
+                         [&](int p, int q) { return len(p) > len(q); });
+
+    S.chunk_ptr.resize(chunks + 1, 0);
+    S.chunk_len.resize(chunks, 0);
+    for (long c = 0; c < chunks; c++) {
+        long width = 0;
+        for (int l = 0; l < C; l++)
+            if (S.perm[c * C + l] >= 0)
+                width = std::max(width, len(S.perm[c * C + l]));
+        S.chunk_len[c] = (int)width;
+        S.chunk_ptr[c + 1] = S.chunk_ptr[c] + width * C;
+    }
+    S.col.resize(S.chunk_ptr[chunks]);
+    S.val.resize(S.chunk_ptr[chunks]);
+    #pragma omp parallel for schedule(static)
+    for (long c = 0; c < chunks; c++) {
+        for (int l = 0; l < C; l++) {
+            const int r = S.perm[c * C + l];
+            const long rl = r >= 0 ? len(r) : 0;
+            for (long k = 0; k < S.chunk_len[c]; k++) {
+                const long slot = S.chunk_ptr[c] + k * C + l;
+                S.col[slot] = k < rl ? A.col[A.row_ptr[r] + k] : std::max(r, 0);
+                S.val[slot] = k < rl ? A.val[A.row_ptr[r] + k] : 0.0;
+            }
+        }
+    }
+    return S;
+}
+
+// y = A·x для SELL-C-σ (y в исходном порядке строк); вызывают все потоки команды
+inline void sell_spmv(const SellMatrix& S, const double* x, double* y) {
+    const int C = S.C;
+    #pragma omp for schedule(static)
+    for (long c = 0; c < S.chunks(); c++) {
+        double acc[32] = {};
+        const int* col = S.col.data() + S.chunk_ptr[c];
+        const double* val = S.val.data() + S.chunk_ptr[c];
+        for (int k = 0; k < S.chunk_len[c]; k++, col += C, val += C) {
+            #pragma omp simd
+            for (int l = 0; l < C; l++)
+                acc[l] += val[l] * x[col[l]];
+        }
+        for (int l = 0; l < C; l++) {
+            const int r = S.perm[c * C + l];
+            if (r >= 0)
+                y[r] = acc[l];
+        }
+    }
+}
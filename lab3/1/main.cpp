@@ -3,8 +3,16 @@
 #include <thread>
 #include <mutex>
 #include <omp.h>
-
-void init_matrix(std::vector<std::vector<int>>& matrix, int rows, int cols, int start, int end) {
+#include <string>
+#include <memory>
+#include <algorithm>
+#include "matrix.h"
+#include "mapped_matrix.h"
+#include "harness.h"
+#include "perf_counters.h"
+
+template <typename M>
+void init_matrix(M& matrix, int rows, int cols, int start, int end) {
     std::mutex mtx;
     for (int i = start; i < end; i++) {
         for (int j = 0; j < cols; j++) {
@@ -24,96 +32,173 @@ void init_vector(std::vector<int>& vector, int size, int start, int end) {
     }
 }
 
-void multiply(std::vector<std::vector<int>>& matrix, std::vector<int>& vector, std::vector<int>& result, int rows, int cols, int start, int end) {
+template <typename M>
+void multiply(const M& matrix, std::vector<int>& vector, std::vector<int>& result, int rows, int cols, int start, int end) {
     for (int i = start; i < end; i++) {
+        const int* row = matrix.row(i);
         int sum = 0;
         for (int j = 0; j < cols; j++) {
-            sum += matrix[i][j] * vector[j];
+            sum += row[j] * vector[j];
         }
         result[i] = sum;
     }
 }
 
-int main() {
-    int sizes[2] = {20000, 40000};
-    int threads[8] = {1,2,4,7,8,16,20,40};
-    int m, n;
-    double S;
-    int num_threads;
-    double final_time;
-    double input20[8];
-    double input40[8];
-    for (int k = 0; k < 2; k++) {
-        m = sizes[k];
-        n = sizes[k];
-        std::cout << "Size = " << n  << std::endl;
-        for (int j = 0; j < 8; j++) {
-            num_threads = threads[j];
-            std::vector<std::vector<int>> matrix(m, std::vector<int>(n));
-            std::vector<int> vector(n);
-            std::vector<int> result(m);
-
-            std::vector<std::thread> threads(num_threads);
-
-            double start_time = omp_get_wtime();
-
-            int chunk_size = m / num_threads;
-
-            for (int i = 0; i < num_threads; i++) {
-                int start = i * chunk_size;
-                int end = (i == num_threads - 1) ? m : start + chunk_size;
-                threads[i] = std::thread(init_matrix, std::ref(matrix), m, n, start, end);
-            }
-
-            for (auto& t : threads) {
-                t.join();
+// Умножение на k векторов сразу: Y = A·X, X — n×k, Y — m×k (вектор v — столбец v).
+// Строка матрицы читается из памяти один раз для всех k векторов, на каждый
+// элемент A приходится k умножений вместо одного. Векторы идут группами по G:
+// acc[G] держится в регистрах, x[j][v0..v0+G-1] лежит подряд.
+// Хвост группы читает выравнивающие нули в конце строки X (ld кратен 16).
+template <int G, typename M>
+void multiply_group(const M& matrix, const Matrix<int>& X, Matrix<int>& Y, int cols, int k, int start, int end) {
+    for (int i = start; i < end; i++) {
+        const int* row = matrix.row(i);
+        for (int v0 = 0; v0 < k; v0 += G) {
+            int acc[G] = {};
+            for (int j = 0; j < cols; j++) {
+                const int a = row[j];
+                const int* x = X.row(j) + v0;
+                for (int v = 0; v < G; v++)
+                    acc[v] += a * x[v];
             }
+            for (int v = 0; v < std::min(G, k - v0); v++)
+                Y(i, v0 + v) = acc[v];
+        }
+    }
+}
 
-            for (int i = 0; i < num_threads; i++) {
-                int start = i * chunk_size;
-                int end = (i == num_threads - 1) ? m : start + chunk_size;
-                threads[i] = std::thread(init_vector, std::ref(vector), n, start, end);
-            }
+// Узкая группа для малых k (лишние нули не умножаются), для больших — целая кэш-линия X
+template <typename M>
+void multiply_batch(const M& matrix, const Matrix<int>& X, Matrix<int>& Y, int cols, int k, int start, int end) {
+    if (k <= 8)
+        multiply_group<8>(matrix, X, Y, cols, k, start, end);
+    else
+        multiply_group<16>(matrix, X, Y, cols, k, start, end);
+}
 
-            for (auto& t : threads) {
-                t.join();
-            }
+// Запуск f(start, end) на num_threads потоках по блокам строк [r0, r1).
+// С probe каждый поток снимает свои счётчики для фазы phase.
+template <typename F>
+void run_threads(int num_threads, int r0, int r1, F f, PhaseProbe* probe = nullptr, size_t phase = 0) {
+    std::vector<std::thread> threads(num_threads);
+    int chunk_size = (r1 - r0) / num_threads;
+    for (int i = 0; i < num_threads; i++) {
+        int start = r0 + i * chunk_size;
+        int end = (i == num_threads - 1) ? r1 : start + chunk_size;
+        if (probe)
+            threads[i] = std::thread([=, &f] { probe->measure(phase, i, [&] { f(start, end); }); });
+        else
+            threads[i] = std::thread(f, start, end);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
 
-            for (int i = 0; i < num_threads; i++) {
-                int start = i * chunk_size;
-                int end = (i == num_threads - 1) ? m : start + chunk_size;
-                threads[i] = std::thread(multiply, std::ref(matrix), std::ref(vector), std::ref(result), m, n, start, end);
-            }
+// init_matrix, init_vector и multiply, каждый этап на num_threads потоках
+double run_memory(Matrix<int>& matrix, std::vector<int>& vector, std::vector<int>& result, int m, int n, int num_threads,
+                  PhaseProbe* probe = nullptr) {
+    double start_time = omp_get_wtime();
+    run_threads(num_threads, 0, m, [&](int start, int end) { init_matrix(matrix, m, n, start, end); }, probe, 0);
+    run_threads(num_threads, 0, n, [&](int start, int end) { init_vector(vector, n, start, end); }, probe, 1);
+    run_threads(num_threads, 0, m, [&](int start, int end) { multiply(matrix, vector, result, m, n, start, end); }, probe, 2);
+    return omp_get_wtime() - start_time;
+}
 
-            for (auto& t : threads) {
-                t.join();
-            }
+// Матрица в файле: init_matrix и multiply по тайлам, в памяти только окно.
+// Возвращает время, в io_bytes — объём данных, прошедших через диск.
+double run_mapped(MappedMatrix<int>& matrix, std::vector<int>& vector, std::vector<int>& result, int m, int n, int num_threads,
+                  size_t window_bytes, double& io_bytes) {
+    const size_t tile_rows = tile_rows_for(matrix, window_bytes);
+    double start_time = omp_get_wtime();
+    io_bytes = for_each_tile(matrix, tile_rows, true, [&](size_t r0, size_t r1) {
+        run_threads(num_threads, (int)r0, (int)r1, [&](int start, int end) { init_matrix(matrix, m, n, start, end); });
+    });
+    run_threads(num_threads, 0, n, [&](int start, int end) { init_vector(vector, n, start, end); });
+    io_bytes += for_each_tile(matrix, tile_rows, false, [&](size_t r0, size_t r1) {
+        run_threads(num_threads, (int)r0, (int)r1, [&](int start, int end) { multiply(matrix, vector, result, m, n, start, end); });
+    });
+    return omp_get_wtime() - start_time;
+}
 
-            double end_time = omp_get_wtime();
-            final_time = end_time - start_time;
-            if (num_threads == 1) {
-                S = final_time;
-                std::cout << "T = " << S << " seconds." << std::endl;
-                if (n == 20000) input20[0] = 1;
-                else input40[0] = 1;
-            }
-            else {
-                std::cout << "T" << num_threads <<" = " << final_time << " seconds. " << "S" << num_threads << " = " << S/final_time << std::endl;
-                if (n == 20000) input20[j] = S/final_time;
-                else input40[j] = S/final_time;
-            }
-        }
-    }
-    for(int i =0; i < 8; i++) {
-        std::cout << input20[i] << ", ";
+int main(int argc, char** argv) {
+    Harness h(argc, argv, {20000, 40000}, {1, 2, 4, 7, 8, 16, 20, 40});
+    // --perf: счётчики по фазам, каждый std::thread снимает свои
+    PhaseProbe phases({"init_matrix", "init_vector", "multiply"});
+    PhaseProbe* probe = nullptr;
+    if (h.flag("perf")) {
+        probe = &phases;
+        h.probe(probe);
     }
-    std::cout << std::endl;
 
-    for(int i =0; i < 8; i++) {
-        std::cout << input40[i] << ", ";
+    // --pages small,thp,hugetlb — матрица на разных страницах
+    const std::vector<std::string> pages = h.list("pages", "thp");
+    for (const std::string& page : pages) {
+        const PagePolicy policy = page_policy_from_name(page, PagePolicy::Transparent);
+        h.add(pages.size() > 1 ? "matvec/" + page : std::string("matvec"), [probe, policy](long n) {
+            auto matrix = std::make_shared<Matrix<int>>(n, n, policy);
+            auto vector = std::make_shared<std::vector<int>>(n);
+            auto result = std::make_shared<std::vector<int>>(n);
+            Case c;
+            c.run = [=](int threads) { return run_memory(*matrix, *vector, *result, (int)n, (int)n, threads, probe); };
+            c.tags = {{"pages", page_policy_name(matrix->pages())}};
+            return c;
+        });
     }
-    std::cout << std::endl;
 
+    // --batch 1,2,4,8,16 — матрица на k векторов сразу (batch/k), время только умножения
+    const int max_threads = *std::max_element(h.threads().begin(), h.threads().end());
+    for (const std::string& kb : h.list("batch", "")) {
+        const int k = std::max(1, std::stoi(kb));
+        h.add("batch/" + std::to_string(k), [k, max_threads](long n) {
+            auto matrix = std::make_shared<Matrix<int>>(n, n);
+            auto X = std::make_shared<Matrix<int>>(n, k);
+            auto Y = std::make_shared<Matrix<int>>(n, k);
+            run_threads(max_threads, 0, (int)n, [&](int start, int end) { init_matrix(*matrix, (int)n, (int)n, start, end); });
+            for (long j = 0; j < n; j++)
+                for (size_t v = 0; v < X->ld(); v++)
+                    (*X)(j, v) = v < (size_t)k ? (int)((j + v) % 7) : 0;
+
+            // Сверка последнего вектора с обычным multiply
+            std::vector<int> x(n), y(n);
+            for (long j = 0; j < n; j++)
+                x[j] = (*X)(j, k - 1);
+            multiply(*matrix, x, y, (int)n, (int)n, 0, (int)n);
+            multiply_batch(*matrix, *X, *Y, (int)n, k, 0, (int)n);
+            bool ok = true;
+            for (long i = 0; i < n; i++)
+                ok = ok && (*Y)(i, k - 1) == y[i];
+
+            Case c;
+            c.run = [=](int threads) {
+                double start_time = omp_get_wtime();
+                run_threads(threads, 0, (int)n, [&](int start, int end) { multiply_batch(*matrix, *X, *Y, (int)n, k, start, end); });
+                return omp_get_wtime() - start_time;
+            };
+            c.rates = {{"Gmul/s", (double)n * n * k / 1e9}, {"GB/s", (double)matrix->bytes() / 1e9}};
+            c.tags = {{"k", std::to_string(k)}, {"check", ok ? "ok" : "FAIL"}};
+            return c;
+        });
+    }
 
-    return 0;
-}
\ No newline at end of file
+    // --mmap файл [--window-mb M] — матрица в файле вместо памяти
+    const std::string mmap_path = h.option("mmap", "");
+    const size_t window_bytes = (size_t)h.option("window-mb", 512L) << 20;
+    if (!mmap_path.empty()) {
+        h.add("mmap", [&](long n) {
+            auto matrix = std::make_shared<MappedMatrix<int>>(mmap_path, n, n);
+            auto vector = std::make_shared<std::vector<int>>(n);
+            auto result = std::make_shared<std::vector<int>>(n);
+            Case c;
+            c.run = [=, &h](int threads) {
+                double io_bytes;
+                double t = run_mapped(*matrix, *vector, *result, (int)n, (int)n, threads, window_bytes, io_bytes);
+                h.metric("disk GB/s", io_bytes / 1e9 / t);
+                return t;
+            };
+            c.tags = {{"window-mb", std::to_string(window_bytes >> 20)}};
+            return c;
+        });
+    }
+    return h.run();
+}
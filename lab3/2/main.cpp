@@ -10,6 +10,9 @@
 #include <fstream>
 #include <random>
 #include <iomanip>
+#include <algorithm>
+#include "harness.h"
+#include "vmath.h"
 
 template<typename T>
 T f_pow(T x, T y)
@@ -167,18 +170,193 @@ void client(Server<double>& server,int N,int func_type,const std::string& filena
     file.close();
 }
 
-int main()
+// Пакетный клиент: batch запросов одной задачей, сервер считает их
+// векторными vpow / vsin / vsqrt за один вызов
+void client_batch(Server<std::vector<double>>& server, int N, int func_type, const std::string& filename, int batch)
 {
-    int N = 10000;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dist(1, 10);
+    std::uniform_real_distribution<double> dist_real(0.0, 10.0);
+    const char* names[3] = {"pow", "sin", "sqrt"};
+
+    std::ofstream file(filename);
+    for (int i0 = 0; i0 < N; i0 += batch)
+    {
+        const int len = std::min(batch, N - i0);
+        std::vector<double> arg1(len), arg2(len);
+        for (int j = 0; j < len; j++)
+        {
+            // те же аргументы, что и у client: целые
+            arg1[j] = func_type == 0 ? dist(gen) : (int)dist_real(gen);
+            arg2[j] = func_type == 0 ? dist(gen) : 0;
+        }
+        std::packaged_task<std::vector<double>()> task([=]() {
+            std::vector<double> res(len);
+            if (func_type == 0) vpow(arg1.data(), arg2.data(), res.data(), len);
+            if (func_type == 1) vsin(arg1.data(), res.data(), len);
+            if (func_type == 2) vsqrt(arg1.data(), res.data(), len);
+            return res;
+        });
+        size_t idx = server.add_task(std::move(task));
+        std::vector<double> res = server.request_result(idx);
+
+        for (int j = 0; j < len; j++)
+        {
+            double ref = func_type == 0 ? std::pow(arg1[j], arg2[j]) : func_type == 1 ? std::sin(arg1[j]) : std::sqrt(arg1[j]);
+            std::string cor = std::abs(ref - res[j]) < 1e-9 ? "correct" : "incorrect";
+            file << names[func_type] << " " << arg1[j];
+            if (func_type == 0)
+                file << " " << arg2[j];
+            file << " = " << res[j] << " " << cor << std::endl;
+        }
+    }
+    file.close();
+}
+
+// Сверка vmath с libm на случайных аргументах для всех доступных наборов
+// инструкций; границы — из комментария в vmath.h. Возвращает код выхода.
+int check_ulp(long samples)
+{
+    std::mt19937_64 gen(12345);
+    std::vector<double> x(samples), y(samples), z(samples);
+    auto fill = [&](std::vector<double>& v, double lo, double hi) {
+        std::uniform_real_distribution<double> d(lo, hi);
+        for (double& e : v) e = d(gen);
+    };
+    bool ok = true;
+    auto report = [&](Isa isa, const char* name, double worst, double bound) {
+        bool pass = worst <= bound;
+        ok = ok && pass;
+        std::cout << std::left << std::setw(8) << isa_name(isa) << std::setw(22) << name << " max ULP = " << std::setw(8) << worst
+                  << " bound = " << bound << (pass ? "  ok" : "  FAIL") << std::endl;
+    };
+    const Isa all[] = {Isa::Scalar, Isa::Avx2, Isa::Avx512};
+    for (Isa isa : all)
+    {
+        if (isa > detect_isa())
+            continue;
+        const VMathKernels k = select_vmath_kernels(isa);
+        double worst;
+
+        fill(x, -745.0, 710.0);
+        k.exp(x.data(), y.data(), samples);
+        worst = 0;
+        for (long i = 0; i < samples; i++) worst = std::max(worst, ulp_distance(y[i], std::exp(x[i])));
+        report(isa, "exp [-745, 710]", worst, 1);
+
+        fill(x, -10.0, 10.0);
+        k.sin(x.data(), y.data(), samples);
+        worst = 0;
+        for (long i = 0; i < samples; i++) worst = std::max(worst, ulp_distance(y[i], std::sin(x[i])));
+        report(isa, "sin [-10, 10]", worst, 1);
+
+        fill(x, -1e5, 1e5);
+        k.sin(x.data(), y.data(), samples);
+        worst = 0;
+        for (long i = 0; i < samples; i++) worst = std::max(worst, ulp_distance(y[i], std::sin(x[i])));
+        report(isa, "sin [-1e5, 1e5]", worst, 2);
+
+        fill(x, 0.0, 1e6);
+        k.sqrt(x.data(), y.data(), samples);
+        worst = 0;
+        for (long i = 0; i < samples; i++) worst = std::max(worst, ulp_distance(y[i], std::sqrt(x[i])));
+        report(isa, "sqrt [0, 1e6]", worst, 0);
+
+        for (long i = 0; i < samples; i++)
+        {
+            x[i] = (double)(1 + gen() % 10);
+            z[i] = (double)(1 + gen() % 10);
+        }
+        k.pow(x.data(), z.data(), y.data(), samples);
+        worst = 0;
+        for (long i = 0; i < samples; i++) worst = std::max(worst, ulp_distance(y[i], std::pow(x[i], z[i])));
+        report(isa, "pow {1..10}^{1..10}", worst, 0);
+
+        fill(x, 0.0, 10.0);
+        fill(z, -20.0, 20.0);
+        k.pow(x.data(), z.data(), y.data(), samples);
+        worst = 0;
+        for (long i = 0; i < samples; i++)
+            worst = std::max(worst, ulp_distance(y[i], std::pow(x[i], z[i])) / (1 + std::abs(z[i] * std::log(x[i]))));
+        report(isa, "pow / (1 + |y ln x|)", worst, 3);
+
+        // |y·ln x| > 708: переполнение и исчезновение — всё через libm, точно
+        const double edge_x[] = {2.0, 2.0, 3.0}, edge_y[] = {3607.5, -3607.5, 2000.25};
+        for (long i = 0; i < samples; i++)
+        {
+            x[i] = i < 3 ? edge_x[i] : 2.0 + 8.0 * (double)(gen() >> 11) * 0x1p-53;
+            z[i] = i < 3 ? edge_y[i] : (gen() & 1 ? 1.0 : -1.0) * (1100.0 + 2900.0 * (double)(gen() >> 11) * 0x1p-53);
+        }
+        k.pow(x.data(), z.data(), y.data(), samples);
+        worst = 0;
+        for (long i = 0; i < samples; i++) worst = std::max(worst, ulp_distance(y[i], std::pow(x[i], z[i])));
+        report(isa, "pow |y ln x| > 708", worst, 0);
+    }
+    return ok ? 0 : 1;
+}
+
+// Один прогон: clients клиентов по N запросов (функции по кругу pow, sin, sqrt)
+double run_server(int N, int clients) {
+    const char* names[3] = {"pow", "sin", "sqrt"};
+    auto start = std::chrono::steady_clock::now();
     Server<double> server;
     server.start();
-    std::thread client_pow(client,std::ref(server),N,0,"pow.txt");
-    std::thread client_sin(client,std::ref(server),N,1,"sin.txt");
-    std::thread client_sqrt(client,std::ref(server),N,2,"sqrt.txt");
-
-    client_pow.join();
-    client_sin.join();
-    client_sqrt.join();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < clients; i++) {
+        std::string filename = std::string(names[i % 3]) + (i < 3 ? "" : "_" + std::to_string(i)) + ".txt";
+        threads.emplace_back(client, std::ref(server), N, i % 3, filename);
+    }
+    for (auto& t : threads)
+        t.join();
+    server.stop();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 
+// То же с пакетными клиентами (batch запросов в задаче)
+double run_server_batch(int N, int clients, int batch) {
+    const char* names[3] = {"pow", "sin", "sqrt"};
+    auto start = std::chrono::steady_clock::now();
+    Server<std::vector<double>> server;
+    server.start();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < clients; i++) {
+        std::string filename = std::string(names[i % 3]) + "_batch" + (i < 3 ? "" : "_" + std::to_string(i)) + ".txt";
+        threads.emplace_back(client_batch, std::ref(server), N, i % 3, filename, batch);
+    }
+    for (auto& t : threads)
+        t.join();
     server.stop();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    // размер — число запросов на клиента, потоки — число клиентов
+    Harness h(argc, argv, {10000}, {3});
+    // --check-ulp [--samples N] — только проверка точности vmath против libm
+    if (h.flag("check-ulp"))
+        return check_ulp(h.option("samples", 1L << 20));
+    h.add("server", [&h](long N) {
+        Case c;
+        c.run = [&h, N](int clients) {
+            double t = run_server((int)N, clients);
+            h.metric("Mreq/s", (double)N * clients / 1e6 / t);
+            return t;
+        };
+        return c;
+    });
+    // --batch B — запросов в одной задаче для пакетного варианта
+    const int batch = std::max(1, h.option("batch", 256));
+    h.add("server-batch", [&h, batch](long N) {
+        Case c;
+        c.run = [&h, N, batch](int clients) {
+            double t = run_server_batch((int)N, clients, batch);
+            h.metric("Mreq/s", (double)N * clients / 1e6 / t);
+            return t;
+        };
+        c.tags = {{"batch", std::to_string(batch)}, {"isa", isa_name(vmath().isa)}};
+        return c;
+    });
+    return h.run();
 }